@@ -0,0 +1,22 @@
+#pragma once
+#include <cerrno>
+#include <cstdlib>
+
+// Numeric option values: the whole argument must parse and lie in [min, max]
+inline bool parseIntArg(const char* text, long min, long max, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+inline bool parseDoubleArg(const char* text, double min, double max, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !(parsed >= min && parsed <= max)) return false;
+    value = parsed;
+    return true;
+}
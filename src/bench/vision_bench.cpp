@@ -0,0 +1,1046 @@
+// Microbenchmarks for the vision post-processing hot paths.
+//
+// Usage: vision_bench <benchmark> [args]
+//   decode [output.bin]   SIMD decoder vs. the original scalar loop, plus 5- and
+//                         10-class allow-list decodes. output.bin is a
+//                         raw [1,84,8400] float tensor recorded with the 'o' key in
+//                         agent_app; a synthetic tensor is used when omitted.
+//   nms [count...]        Grid/SIMD NmsEngine vs. the original O(n^2) loop on
+//                         synthetic dense candidate sets (default 100 500 2000 5000).
+//   batch <model.onnx> [maxN]
+//                         End-to-end frames/s of detectBatch() for N = 1, 2, 4, ...
+//                         maxN (default 8) against N sequential detect() calls.
+//                         Needs a model exported with a dynamic batch dimension.
+//   tiles <model.onnx> [WxH...]
+//                         detectTiled() latency vs. tile count for a range of frame
+//                         sizes (default 1280x720 1920x1080 2560x1440 3840x2160),
+//                         with detect() on the same frame as the baseline.
+//   compare <fp32.onnx> <int8.onnx> <image_dir> [label_dir]
+//                         Runs both models on the same images and reports the speedup
+//                         and mAP@0.5. With YOLO-format labels (<stem>.txt: class cx cy
+//                         w h, normalized) both models are scored against them;
+//                         otherwise the INT8 model is scored against the fp32 output.
+//   layouts               Total post-processing time of the YOLOv8 anchor layout
+//                         (decode + candidate boxes + NMS) vs. an end-to-end
+//                         YOLOv10-style [300, 6] output (decode + boxes, no NMS).
+//   session <model.onnx> [iterations]
+//                         The startup self-benchmark over every candidate session
+//                         configuration (threads, spinning, XNNPACK), fastest first.
+//   tracker [count...]    Kalman/Hungarian SimpleTracker vs. the original greedy
+//                         smoothing tracker on synthetic scenes of moving objects
+//                         (default 100 500 1000): time per frame and tracks started,
+//                         where every start beyond the object count is a broken track.
+//   trackcost [count...]  Tracker cost matrix: the SoA/SIMD kernel vs. a per-pair
+//                         cv::Rect loop over array-of-structs tracks, on the same scenes
+//                         (default 10 100 1000), plus the full updateTracks() time.
+//   overlay [count]       Per-frame cost of drawing count labelled detections
+//                         (default 20) plus the HUD lines on a 1280x720 frame:
+//                         getTextSize/putText per string vs. OverlayRenderer's
+//                         cached glyph strips.
+//   jpeg [image.jpg] [iterations]
+//                         JpegDecoder at full, 1/2 and 1/4 scale vs. a full decode
+//                         plus INTER_AREA resize to the same size, on the given JPEG
+//                         or a synthetic 1280x720 camera-like frame.
+//   allocs <model.onnx> [frames]
+//                         Heap allocations per steady-state detect() on a 1280x720
+//                         frame, minus those of a bare Session::Run on the same
+//                         model. Fails unless VisionModule's own share is zero.
+#include "vision/decoder.h"
+#include "vision/nms.h"
+#include "vision/classpolicy.h"
+#include "vision/visionmodule.h"
+#include "vision/sessiontuner.h"
+#include "tracking/tracker.h"
+#include "render/overlayrenderer.h"
+#include "capture/jpegdecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr int NUM_CLASSES = 80;
+static constexpr int64_t NUM_PREDS = 8400;
+
+// Every operator new in this binary is counted per thread for the allocs
+// benchmark; the array and nothrow forms route through these
+static thread_local uint64_t threadAllocations = 0;
+
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    threadAllocations++;
+    void* p = nullptr;
+    const size_t align = std::max(sizeof(void*), static_cast<size_t>(alignment));
+    if (posix_memalign(&p, align, size ? size : 1) == 0) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+// Median wall time of fn() in microseconds
+static double timeIt(const std::function<void()>& fn, int iterations) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    fn();  // warm-up
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Mostly-background tensor with a few hundred confident anchors, similar to a
+// cluttered indoor frame
+static std::vector<float> syntheticOutput(uint32_t seed) {
+    std::vector<float> data((4 + NUM_CLASSES) * NUM_PREDS);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    for (int64_t i = 0; i < 4 * NUM_PREDS; i++) data[i] = uni(rng) * 640.0f;
+    for (int64_t i = 4 * NUM_PREDS; i < static_cast<int64_t>(data.size()); i++) {
+        data[i] = uni(rng) * uni(rng) * 0.1f;
+    }
+    for (int k = 0; k < 300; k++) {
+        int64_t anchor = rng() % NUM_PREDS;
+        int cls = rng() % NUM_CLASSES;
+        data[(4 + cls) * NUM_PREDS + anchor] = 0.2f + 0.8f * uni(rng);
+    }
+    return data;
+}
+
+static bool loadOutput(const std::string& path, std::vector<float>& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.resize((4 + NUM_CLASSES) * NUM_PREDS);
+    in.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(float));
+    return in.gcount() == static_cast<std::streamsize>(data.size() * sizeof(float));
+}
+
+static int benchDecode(int argc, char** argv) {
+    std::vector<float> data;
+    if (argc > 0) {
+        if (!loadOutput(argv[0], data)) {
+            std::cerr << "Failed to read [1,84,8400] tensor from " << argv[0] << std::endl;
+            return 1;
+        }
+        std::cout << "Recorded tensor: " << argv[0] << std::endl;
+    } else {
+        data = syntheticOutput(42);
+        std::cout << "Synthetic tensor (pass a recorded output.bin for real data)" << std::endl;
+    }
+
+    const float minScore = 0.25f;
+    std::vector<DecodedAnchor> simd, scalar;
+    simd.reserve(NUM_PREDS);
+    scalar.reserve(NUM_PREDS);
+
+    YoloDecoder::decode(data.data(), NUM_CLASSES, NUM_PREDS, minScore, simd);
+    YoloDecoder::decodeScalar(data.data(), NUM_CLASSES, NUM_PREDS, minScore, scalar);
+    bool match = simd.size() == scalar.size();
+    for (size_t i = 0; match && i < simd.size(); i++) {
+        match = simd[i].anchor == scalar[i].anchor && simd[i].classId == scalar[i].classId &&
+                simd[i].score == scalar[i].score;
+    }
+
+    const int iterations = 200;
+    double scalarUs = timeIt([&] {
+        scalar.clear();
+        YoloDecoder::decodeScalar(data.data(), NUM_CLASSES, NUM_PREDS, minScore, scalar);
+    }, iterations);
+    double simdUs = timeIt([&] {
+        simd.clear();
+        YoloDecoder::decode(data.data(), NUM_CLASSES, NUM_PREDS, minScore, simd);
+    }, iterations);
+
+    std::cout << "Survivors: " << simd.size() << (match ? " (results match)" : " (MISMATCH)") << std::endl;
+    std::cout << "Scalar loop:  " << scalarUs << " us" << std::endl;
+    std::cout << "SIMD decoder: " << simdUs << " us" << std::endl;
+    std::cout << "Speedup:      " << scalarUs / simdUs << "x" << std::endl;
+
+    // Class allow-lists: the argmax only walks the selected score rows
+    static constexpr int SUBSET_CLASSES[] = {0, 2, 5, 7, 16, 24, 39, 56, 62, 67};
+    for (int classCount : {5, 10}) {
+        double subsetUs = timeIt([&] {
+            simd.clear();
+            YoloDecoder::decodeSubset(data.data(), SUBSET_CLASSES, classCount, NUM_PREDS, minScore, simd);
+        }, iterations);
+        std::cout << classCount << "-class subset: " << subsetUs << " us (" << simdUs / subsetUs << "x)" << std::endl;
+    }
+    return match ? 0 : 1;
+}
+
+struct BenchBox {
+    int x, y, w, h;
+    float score;
+    int classId;
+};
+
+static float rectIou(const BenchBox& a, const BenchBox& b) {
+    int x1 = std::max(a.x, b.x), y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.w, b.x + b.w), y2 = std::min(a.y + a.h, b.y + b.h);
+    float inter = (x2 > x1 && y2 > y1) ? static_cast<float>((x2 - x1) * (y2 - y1)) : 0.0f;
+    float uni = a.w * a.h + b.w * b.h - inter;
+    return (uni > 0) ? inter / uni : 0.0f;
+}
+
+// The original detect() suppression loop, kept as the reference. Sorted
+// stably like the engine, so equal scores resolve the same way in both.
+static void legacyNms(std::vector<BenchBox> boxes, std::vector<BenchBox>& kept) {
+    std::stable_sort(boxes.begin(), boxes.end(),
+                     [](const BenchBox& a, const BenchBox& b) { return a.score > b.score; });
+    std::vector<bool> removed(boxes.size(), false);
+    kept.clear();
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (removed[i]) continue;
+        kept.push_back(boxes[i]);
+        float nmsThreshold = 0.4f;
+        if (boxes[i].classId == 0) nmsThreshold = 0.3f;
+        else if (boxes[i].classId >= 56 && boxes[i].classId <= 60) nmsThreshold = 0.5f;
+        else if (boxes[i].classId >= 61 && boxes[i].classId <= 67) nmsThreshold = 0.6f;
+        for (size_t j = i + 1; j < boxes.size(); j++) {
+            if (removed[j]) continue;
+            float iouValue = rectIou(boxes[i], boxes[j]);
+            if (boxes[i].classId == boxes[j].classId && iouValue > nmsThreshold) removed[j] = true;
+            else if (iouValue > 0.8f) removed[j] = true;
+        }
+    }
+}
+
+// Clusters of jittered boxes around object centres on a 1280x720 frame, the
+// pattern a low CONF_THRESH produces in cluttered scenes
+static std::vector<BenchBox> syntheticCandidates(int count, uint32_t seed) {
+    static const int classes[] = {0, 0, 0, 56, 57, 60, 62, 63, 66, 39, 41, 73};
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    std::vector<BenchBox> boxes;
+    boxes.reserve(count);
+    int objects = std::max(1, count / 12);
+    for (int k = 0; k < count; k++) {
+        std::mt19937 objRng(seed + 1000 + (k % objects));
+        std::uniform_real_distribution<float> objUni(0.0f, 1.0f);
+        int cx = static_cast<int>(objUni(objRng) * 1280), cy = static_cast<int>(objUni(objRng) * 720);
+        int w = 20 + static_cast<int>(objUni(objRng) * 250), h = 20 + static_cast<int>(objUni(objRng) * 250);
+        int cls = classes[objRng() % (sizeof(classes) / sizeof(classes[0]))];
+        int jw = static_cast<int>(w * (0.85f + 0.3f * uni(rng)));
+        int jh = static_cast<int>(h * (0.85f + 0.3f * uni(rng)));
+        int x = std::max(0, cx - jw / 2 + static_cast<int>((uni(rng) - 0.5f) * 0.2f * w));
+        int y = std::max(0, cy - jh / 2 + static_cast<int>((uni(rng) - 0.5f) * 0.2f * h));
+        if (uni(rng) < 0.1f) cls = classes[rng() % (sizeof(classes) / sizeof(classes[0]))];
+        boxes.push_back({x, y, jw, jh, 0.25f + 0.75f * uni(rng), cls});
+    }
+    return boxes;
+}
+
+static int benchNms(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 0; i < argc; i++) counts.push_back(std::atoi(argv[i]));
+    if (counts.empty()) counts = {100, 500, 2000, 5000};
+
+    bool allMatch = true;
+    std::cout << "candidates  kept  legacy(us)  engine(us)  speedup" << std::endl;
+    for (int count : counts) {
+        std::vector<BenchBox> boxes = syntheticCandidates(count, 7);
+        NmsEngine engine;
+        ClassPolicyTable policies;
+        for (int c = 0; c < ClassPolicyTable::NUM_CLASSES; c++) {
+            engine.setClassThreshold(c, policies[c].nmsThreshold);
+        }
+        engine.reserve(boxes.size());
+        auto runEngine = [&] {
+            engine.clear();
+            for (const BenchBox& b : boxes) {
+                engine.add(static_cast<float>(b.x), static_cast<float>(b.y), static_cast<float>(b.w),
+                           static_cast<float>(b.h), b.score, b.classId);
+            }
+            return engine.run();
+        };
+
+        std::vector<BenchBox> legacyKept;
+        legacyNms(boxes, legacyKept);
+        const std::vector<int>& kept = runEngine();
+        bool match = kept.size() == legacyKept.size();
+        for (size_t i = 0; match && i < kept.size(); i++) {
+            const BenchBox& a = boxes[kept[i]];
+            const BenchBox& b = legacyKept[i];
+            match = a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h && a.score == b.score;
+        }
+        allMatch = allMatch && match;
+
+        int iterations = count > 2000 ? 10 : 50;
+        double legacyUs = timeIt([&] { legacyNms(boxes, legacyKept); }, iterations);
+        double engineUs = timeIt([&] { runEngine(); }, iterations);
+        std::cout << count << "  " << kept.size() << (match ? "" : " (MISMATCH)") << "  "
+                  << legacyUs << "  " << engineUs << "  " << legacyUs / engineUs << "x" << std::endl;
+    }
+    return allMatch ? 0 : 1;
+}
+
+static int benchBatch(int argc, char** argv) {
+    if (argc < 1) {
+        std::cerr << "batch: model path required" << std::endl;
+        return 1;
+    }
+    int maxBatch = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+
+    VisionModule vision(argv[0]);
+    if (!vision.init()) return 1;
+    if (!vision.supportsBatch()) {
+        std::cout << "Model has a fixed batch dimension; detectBatch() falls back to sequential runs" << std::endl;
+    }
+
+    // 720p camera-sized frames with random content, one per batch slot
+    std::vector<cv::Mat> frames(maxBatch);
+    for (int i = 0; i < maxBatch; i++) {
+        frames[i].create(720, 1280, CV_8UC3);
+        cv::randu(frames[i], cv::Scalar::all(0), cv::Scalar::all(255));
+    }
+
+    std::cout << "OpenCV threads: " << cv::getNumThreads() << std::endl;
+    std::cout << "N  sequential(fps)  batched(fps)  speedup" << std::endl;
+    std::vector<std::vector<Detection>> results;
+    std::vector<Detection> single;
+    const int iterations = 10;
+    for (int n = 1; n <= maxBatch; n *= 2) {
+        double sequentialUs = timeIt([&] {
+            for (int i = 0; i < n; i++) vision.detect(frames[i], single);
+        }, iterations);
+        double batchedUs = timeIt([&] { vision.detectBatch(frames.data(), n, results); }, iterations);
+        double sequentialFps = n * 1e6 / sequentialUs;
+        double batchedFps = n * 1e6 / batchedUs;
+        std::cout << n << "  " << sequentialFps << "  " << batchedFps << "  "
+                  << batchedFps / sequentialFps << "x" << std::endl;
+    }
+    return 0;
+}
+
+static int benchTiles(int argc, char** argv) {
+    if (argc < 1) {
+        std::cerr << "tiles: model path required" << std::endl;
+        return 1;
+    }
+    std::vector<cv::Size> sizes;
+    for (int i = 1; i < argc; i++) {
+        int width = 0, height = 0;
+        if (std::sscanf(argv[i], "%dx%d", &width, &height) == 2) sizes.push_back(cv::Size(width, height));
+    }
+    if (sizes.empty()) sizes = {{1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160}};
+
+    VisionModule vision(argv[0]);
+    if (!vision.init()) return 1;
+    if (!vision.supportsBatch()) {
+        std::cout << "Model has a fixed batch dimension; tiles run sequentially" << std::endl;
+    }
+
+    std::cout << "OpenCV threads: " << cv::getNumThreads() << std::endl;
+    std::cout << "frame  tiles  detect(ms)  tiled(ms)  per-tile(ms)  objects(full/tiled)" << std::endl;
+    std::vector<Detection> full, tiled;
+    std::vector<cv::Rect> tiles;
+    const int iterations = 10;
+    for (const cv::Size& size : sizes) {
+        cv::Mat frame(size.height, size.width, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        VisionModule::computeTiles(size, vision.tiling(), tiles);
+        size_t runs = tiles.size() + (tiles.size() > 1 && vision.tiling().fullFrameView ? 1 : 0);
+
+        double detectUs = timeIt([&] { vision.detect(frame, full); }, iterations);
+        double tiledUs = timeIt([&] { vision.detectTiled(frame, tiled); }, iterations);
+        std::cout << size.width << "x" << size.height << "  " << runs << "  " << detectUs / 1000.0 << "  "
+                  << tiledUs / 1000.0 << "  " << tiledUs / 1000.0 / runs << "  "
+                  << full.size() << "/" << tiled.size() << std::endl;
+    }
+    return 0;
+}
+
+struct EvalImage {
+    std::vector<Detection> truth;
+    std::vector<Detection> predicted;
+};
+
+static float boxIou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+// COCO-style mAP at IoU 0.5: per class, predictions are matched greedily in
+// score order and AP is the all-point interpolated area under the PR curve.
+// Classes without ground truth are skipped.
+static double meanAveragePrecision(const std::vector<EvalImage>& images) {
+    double apSum = 0.0;
+    int classes = 0;
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        struct Scored {
+            float score;
+            size_t image;
+            const cv::Rect* box;
+        };
+        std::vector<Scored> predictions;
+        size_t truthCount = 0;
+        for (size_t i = 0; i < images.size(); i++) {
+            for (const Detection& d : images[i].truth) truthCount += d.classId == c;
+            for (const Detection& d : images[i].predicted) {
+                if (d.classId == c) predictions.push_back({d.score, i, &d.box});
+            }
+        }
+        if (truthCount == 0) continue;
+        std::sort(predictions.begin(), predictions.end(),
+                  [](const Scored& a, const Scored& b) { return a.score > b.score; });
+
+        std::vector<std::vector<bool>> used(images.size());
+        for (size_t i = 0; i < images.size(); i++) used[i].assign(images[i].truth.size(), false);
+        std::vector<double> precision, recall;
+        size_t tp = 0;
+        for (size_t k = 0; k < predictions.size(); k++) {
+            const Scored& p = predictions[k];
+            const std::vector<Detection>& truth = images[p.image].truth;
+            int best = -1;
+            float bestIou = 0.5f;
+            for (size_t t = 0; t < truth.size(); t++) {
+                if (truth[t].classId != c || used[p.image][t]) continue;
+                float iou = boxIou(*p.box, truth[t].box);
+                if (iou >= bestIou) {
+                    bestIou = iou;
+                    best = static_cast<int>(t);
+                }
+            }
+            if (best >= 0) {
+                used[p.image][best] = true;
+                tp++;
+            }
+            precision.push_back(static_cast<double>(tp) / (k + 1));
+            recall.push_back(static_cast<double>(tp) / truthCount);
+        }
+
+        // Precision envelope (max precision at any higher recall), then integrate
+        for (size_t k = precision.size(); k-- > 1;) precision[k - 1] = std::max(precision[k - 1], precision[k]);
+        double ap = 0.0, previousRecall = 0.0;
+        for (size_t k = 0; k < precision.size(); k++) {
+            ap += (recall[k] - previousRecall) * precision[k];
+            previousRecall = recall[k];
+        }
+        apSum += ap;
+        classes++;
+    }
+    return classes > 0 ? apSum / classes : 0.0;
+}
+
+static bool loadYoloLabels(const std::filesystem::path& path, const cv::Size& frameSize,
+                           std::vector<Detection>& truth) {
+    std::ifstream in(path);
+    if (!in) return false;
+    int classId = 0;
+    float cx = 0, cy = 0, w = 0, h = 0;
+    while (in >> classId >> cx >> cy >> w >> h) {
+        cv::Rect box(static_cast<int>((cx - w / 2) * frameSize.width), static_cast<int>((cy - h / 2) * frameSize.height),
+                     static_cast<int>(w * frameSize.width), static_cast<int>(h * frameSize.height));
+        truth.push_back({classId, 1.0f, box});
+    }
+    return true;
+}
+
+static int benchCompare(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    if (argc < 3) {
+        std::cerr << "compare: <fp32.onnx> <int8.onnx> <image_dir> [label_dir] required" << std::endl;
+        return 1;
+    }
+    const bool haveLabels = argc > 3;
+
+    VisionModule reference(argv[0]);
+    VisionModule quantized(argv[1]);
+    if (!reference.init() || !quantized.init()) return 1;
+
+    std::vector<fs::path> images;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(argv[2], ec)) {
+        std::string ext = entry.path().extension().string();
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png") images.push_back(entry.path());
+    }
+    std::sort(images.begin(), images.end());
+    if (images.empty()) {
+        std::cerr << "No images in " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::vector<EvalImage> referenceEval, quantizedEval;
+    std::vector<double> referenceMs, quantizedMs;
+    for (const fs::path& path : images) {
+        cv::Mat frame = cv::imread(path.string(), cv::IMREAD_COLOR);
+        if (frame.empty()) continue;
+        std::vector<Detection> truth;
+        if (haveLabels && !loadYoloLabels(fs::path(argv[3]) / (path.stem().string() + ".txt"), frame.size(), truth)) {
+            continue;  // unlabelled image
+        }
+
+        EvalImage ref, quant;
+        referenceMs.push_back(timeIt([&] { reference.detect(frame, ref.predicted); }, 5) / 1000.0);
+        quantizedMs.push_back(timeIt([&] { quantized.detect(frame, quant.predicted); }, 5) / 1000.0);
+        ref.truth = haveLabels ? truth : ref.predicted;
+        quant.truth = haveLabels ? truth : ref.predicted;
+        referenceEval.push_back(std::move(ref));
+        quantizedEval.push_back(std::move(quant));
+    }
+    if (referenceEval.empty()) {
+        std::cerr << "No usable images" << std::endl;
+        return 1;
+    }
+
+    auto median = [](std::vector<double> v) {
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        return v[v.size() / 2];
+    };
+    double refMs = median(referenceMs), quantMs = median(quantizedMs);
+    double refMap = meanAveragePrecision(referenceEval);
+    double quantMap = meanAveragePrecision(quantizedEval);
+
+    std::cout << "Images: " << referenceEval.size()
+              << (haveLabels ? " (scored against labels)" : " (INT8 scored against fp32 output)") << std::endl;
+    std::cout << reference.modelPrecision() << ":  " << refMs << " ms/frame, mAP@0.5 " << refMap << std::endl;
+    std::cout << quantized.modelPrecision() << ":  " << quantMs << " ms/frame, mAP@0.5 " << quantMap << std::endl;
+    std::cout << "Speedup:   " << refMs / quantMs << "x" << std::endl;
+    std::cout << "mAP delta: " << quantMap - refMap << std::endl;
+    return 0;
+}
+
+// Final-box output as a YOLOv10 head emits it: maxDet rows sorted by score,
+// most of them empty padding
+static std::vector<float> syntheticEndToEnd(int maxDet, int objects, uint32_t seed) {
+    std::vector<float> data(static_cast<size_t>(maxDet) * EndToEndDecoder::ROW_SIZE, 0.0f);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    for (int i = 0; i < objects && i < maxDet; i++) {
+        float* row = data.data() + i * EndToEndDecoder::ROW_SIZE;
+        float x = uni(rng) * 560.0f, y = uni(rng) * 560.0f;
+        row[0] = x;
+        row[1] = y;
+        row[2] = x + 20.0f + uni(rng) * 60.0f;
+        row[3] = y + 20.0f + uni(rng) * 60.0f;
+        row[4] = 0.95f - 0.7f * static_cast<float>(i) / objects;
+        row[5] = static_cast<float>(rng() % NUM_CLASSES);
+    }
+    return data;
+}
+
+static int benchLayouts(int, char**) {
+    const float minScore = 0.25f;
+    const int iterations = 200;
+    std::vector<DecodedAnchor> decoded;
+    decoded.reserve(NUM_PREDS);
+    NmsEngine nms;
+    nms.reserve(NUM_PREDS);
+    std::vector<cv::Rect> boxes;
+    boxes.reserve(NUM_PREDS);
+
+    // Anchor layout: argmax decode, box conversion, class-aware NMS
+    std::vector<float> anchors = syntheticOutput(42);
+    size_t anchorKept = 0;
+    double anchorUs = timeIt([&] {
+        decoded.clear();
+        YoloDecoder::decode(anchors.data(), NUM_CLASSES, NUM_PREDS, minScore, decoded);
+        nms.clear();
+        for (const DecodedAnchor& a : decoded) nms.add(a.cx - a.w / 2, a.cy - a.h / 2, a.w, a.h, a.score, a.classId);
+        boxes.clear();
+        for (int index : nms.run()) {
+            const DecodedAnchor& a = decoded[index];
+            boxes.push_back(cv::Rect(static_cast<int>(a.cx - a.w / 2), static_cast<int>(a.cy - a.h / 2),
+                                     static_cast<int>(a.w), static_cast<int>(a.h)));
+        }
+        anchorKept = boxes.size();
+    }, iterations);
+
+    // End-to-end layout: threshold test and box conversion only
+    std::vector<float> endToEnd = syntheticEndToEnd(300, 40, 42);
+    size_t endToEndKept = 0;
+    double endToEndUs = timeIt([&] {
+        decoded.clear();
+        EndToEndDecoder::decode(endToEnd.data(), 300, NUM_CLASSES, minScore, decoded);
+        boxes.clear();
+        for (const DecodedAnchor& a : decoded) {
+            boxes.push_back(cv::Rect(static_cast<int>(a.cx - a.w / 2), static_cast<int>(a.cy - a.h / 2),
+                                     static_cast<int>(a.w), static_cast<int>(a.h)));
+        }
+        endToEndKept = boxes.size();
+    }, iterations);
+
+    std::cout << "layout            boxes  post-process(us)" << std::endl;
+    std::cout << "anchors [84,8400] " << anchorKept << "  " << anchorUs << std::endl;
+    std::cout << "end-to-end [300,6] " << endToEndKept << "  " << endToEndUs << std::endl;
+    std::cout << "Speedup: " << anchorUs / endToEndUs << "x" << std::endl;
+    return 0;
+}
+
+static int benchSession(int argc, char** argv) {
+    if (argc < 1) {
+        std::cerr << "session: model path required" << std::endl;
+        return 1;
+    }
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+
+    std::vector<SessionTuningResult> results;
+    SessionConfig best;
+    if (!tuneSession(argv[0], defaultSessionCandidates(SessionConfig()), iterations, results, best)) return 1;
+
+    std::stable_sort(results.begin(), results.end(), [](const SessionTuningResult& a, const SessionTuningResult& b) {
+        return (a.medianMs >= 0.0) != (b.medianMs >= 0.0) ? a.medianMs >= 0.0 : a.medianMs < b.medianMs;
+    });
+    std::cout << "median(ms)  options" << std::endl;
+    for (const SessionTuningResult& result : results) {
+        std::cout << result.medianMs << "  " << result.config.describe() << std::endl;
+    }
+    return 0;
+}
+
+// The original greedy tracker, kept as the reference: matches in track-id
+// order and smooths with a fixed 0.7/0.3 blend
+struct LegacyTracker {
+    struct Track {
+        cv::Rect box;
+        int classId;
+        int missedFrames;
+    };
+    std::map<int, Track> tracks;
+    int nextId = 0;
+
+    void update(const std::vector<Detection>& detections, std::vector<Detection>& out) {
+        out.clear();
+        std::vector<bool> matched(detections.size(), false);
+        for (auto& [id, track] : tracks) {
+            track.missedFrames++;
+            float bestIou = 0;
+            int bestMatch = -1;
+            for (size_t i = 0; i < detections.size(); i++) {
+                if (matched[i] || detections[i].classId != track.classId) continue;
+                float inter = static_cast<float>((track.box & detections[i].box).area());
+                float uni = track.box.area() + detections[i].box.area() - inter;
+                float iou = uni > 0 ? inter / uni : 0.0f;
+                if (iou > 0.3f && iou > bestIou) {
+                    bestIou = iou;
+                    bestMatch = static_cast<int>(i);
+                }
+            }
+            if (bestMatch < 0) continue;
+            const cv::Rect& b = detections[bestMatch].box;
+            track.box = cv::Rect(static_cast<int>(0.7f * track.box.x + 0.3f * b.x), static_cast<int>(0.7f * track.box.y + 0.3f * b.y),
+                                 static_cast<int>(0.7f * track.box.width + 0.3f * b.width),
+                                 static_cast<int>(0.7f * track.box.height + 0.3f * b.height));
+            track.missedFrames = 0;
+            matched[bestMatch] = true;
+            out.push_back({track.classId, detections[bestMatch].score, track.box});
+        }
+        for (auto it = tracks.begin(); it != tracks.end();) {
+            if (it->second.missedFrames > 5) it = tracks.erase(it);
+            else ++it;
+        }
+        for (size_t i = 0; i < detections.size(); i++) {
+            if (matched[i]) continue;
+            tracks[nextId++] = {detections[i].box, detections[i].classId, 0};
+            out.push_back(detections[i]);
+        }
+    }
+};
+
+// Objects crossing a canvas sized for constant density (about 100 objects on
+// a 1080p frame) at up to 12 px/frame, bouncing off the edges. Detections
+// jitter by a few pixels, 5% are missed and their order is shuffled.
+struct TrackingScene {
+    struct Object {
+        float x, y, vx, vy;
+        int width, height, classId;
+    };
+    std::vector<Object> objects;
+    cv::Size canvas;
+    std::mt19937 rng;
+
+    TrackingScene(int count, uint32_t seed) : rng(seed) {
+        int width = static_cast<int>(std::sqrt(count * 20736.0f * 16.0f / 9.0f));
+        canvas = cv::Size(width, width * 9 / 16);
+        static const int classes[] = {0, 0, 0, 2, 2, 3, 5, 7};
+        std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+        for (int i = 0; i < count; i++) {
+            Object o;
+            o.width = 24 + static_cast<int>(uni(rng) * 80);
+            o.height = 24 + static_cast<int>(uni(rng) * 120);
+            o.x = uni(rng) * (canvas.width - o.width);
+            o.y = uni(rng) * (canvas.height - o.height);
+            o.vx = (uni(rng) - 0.5f) * 24.0f;
+            o.vy = (uni(rng) - 0.5f) * 24.0f;
+            o.classId = classes[rng() % (sizeof(classes) / sizeof(classes[0]))];
+            objects.push_back(o);
+        }
+    }
+
+    void step(std::vector<Detection>& detections) {
+        std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+        detections.clear();
+        for (Object& o : objects) {
+            o.x += o.vx;
+            o.y += o.vy;
+            if (o.x < 0 || o.x > canvas.width - o.width) o.vx = -o.vx;
+            if (o.y < 0 || o.y > canvas.height - o.height) o.vy = -o.vy;
+            if (uni(rng) < 0.05f) continue;
+            int jx = static_cast<int>((uni(rng) - 0.5f) * 6), jy = static_cast<int>((uni(rng) - 0.5f) * 6);
+            int jw = static_cast<int>((uni(rng) - 0.5f) * 6), jh = static_cast<int>((uni(rng) - 0.5f) * 6);
+            detections.push_back({o.classId, 0.5f + 0.5f * uni(rng),
+                                  cv::Rect(static_cast<int>(o.x) + jx, static_cast<int>(o.y) + jy, o.width + jw, o.height + jh)});
+        }
+        std::shuffle(detections.begin(), detections.end(), rng);
+    }
+};
+
+static int benchTracker(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 0; i < argc; i++) counts.push_back(std::atoi(argv[i]));
+    if (counts.empty()) counts = {100, 500, 1000};
+    static constexpr int FRAMES = 300;
+
+    std::cout << "objects  legacy(us/frame)  engine(us/frame)  speedup  legacy starts  engine starts" << std::endl;
+    for (int count : counts) {
+        // Same detections for both trackers
+        TrackingScene scene(count, 11);
+        std::vector<std::vector<Detection>> frames(FRAMES);
+        for (std::vector<Detection>& detections : frames) scene.step(detections);
+
+        std::vector<Detection> out;
+        LegacyTracker legacy;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::vector<Detection>& detections : frames) legacy.update(detections, out);
+        double legacyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+        SimpleTracker engine;
+        start = std::chrono::steady_clock::now();
+        for (const std::vector<Detection>& detections : frames) engine.updateTracks(detections, out);
+        double engineUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+        std::cout << count << "  " << legacyUs << "  " << engineUs << "  " << legacyUs / engineUs << "x  "
+                  << legacy.nextId << "  " << engine.tracksStarted() << std::endl;
+    }
+    return 0;
+}
+
+// Per-pair cost over array-of-structs tracks, the reference for trackCostRow
+struct AosTrack {
+    cv::Rect box;
+    int classId;
+};
+
+static void referenceCosts(const std::vector<AosTrack>& tracks, const std::vector<Detection>& detections,
+                           const TrackerConfig& config, std::vector<float>& cost) {
+    cost.resize(tracks.size() * detections.size());
+    for (size_t t = 0; t < tracks.size(); t++) {
+        const cv::Rect& a = tracks[t].box;
+        const float diagonal = std::max(1.0f, std::sqrt(static_cast<float>(a.width * a.width + a.height * a.height)));
+        for (size_t d = 0; d < detections.size(); d++) {
+            float& out = cost[t * detections.size() + d];
+            out = LinearAssignment::INVALID_COST;
+            if (detections[d].classId != tracks[t].classId) continue;
+            const cv::Rect& b = detections[d].box;
+            float inter = static_cast<float>((a & b).area());
+            float uni = static_cast<float>(a.area() + b.area()) - inter;
+            float iou = uni > 0 ? inter / uni : 0.0f;
+            float distance = std::hypot(b.x + 0.5f * b.width - (a.x + 0.5f * a.width),
+                                        b.y + 0.5f * b.height - (a.y + 0.5f * a.height)) / diagonal;
+            if (iou < config.iouThreshold && distance > config.maxCenterDistance) continue;
+            out = (1.0f - iou) + distance;
+        }
+    }
+}
+
+static int benchTrackCost(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 0; i < argc; i++) counts.push_back(std::atoi(argv[i]));
+    if (counts.empty()) counts = {10, 100, 1000};
+
+    bool allMatch = true;
+    TrackerConfig config;
+    std::cout << "objects  aos(us)  soa(us)  speedup  update(us/frame)" << std::endl;
+    for (int count : counts) {
+        // Tracks at one frame, detections at the next
+        TrackingScene scene(count, 5);
+        std::vector<Detection> previous, detections;
+        scene.step(previous);
+        scene.step(detections);
+        std::vector<AosTrack> aos;
+        TrackBoxColumns soa;
+        for (const Detection& det : previous) {
+            aos.push_back({det.box, det.classId});
+            soa.push(det.box, det.classId);
+        }
+
+        std::vector<float> reference, costs(aos.size() * detections.size());
+        referenceCosts(aos, detections, config, reference);
+        auto runSoa = [&] {
+            for (size_t d = 0; d < detections.size(); d++) {
+                trackCostRow(detections[d].box, detections[d].classId, soa, config.iouThreshold,
+                             config.maxCenterDistance, costs.data() + d * aos.size());
+            }
+        };
+        runSoa();
+        bool match = true;
+        for (size_t t = 0; match && t < aos.size(); t++) {
+            for (size_t d = 0; match && d < detections.size(); d++) {
+                match = std::fabs(reference[t * detections.size() + d] - costs[d * aos.size() + t]) < 1e-4f;
+            }
+        }
+        allMatch = allMatch && match;
+
+        int iterations = count >= 1000 ? 20 : 200;
+        double aosUs = timeIt([&] { referenceCosts(aos, detections, config, reference); }, iterations);
+        double soaUs = timeIt(runSoa, iterations);
+
+        static constexpr int FRAMES = 100;
+        std::vector<std::vector<Detection>> frames(FRAMES);
+        for (std::vector<Detection>& frame : frames) scene.step(frame);
+        SimpleTracker tracker(config);
+        std::vector<Detection> out;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::vector<Detection>& frame : frames) tracker.updateTracks(frame, out);
+        double updateUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+        std::cout << count << (match ? "" : " (MISMATCH)") << "  " << aosUs << "  " << soaUs << "  "
+                  << aosUs / soaUs << "x  " << updateUs << std::endl;
+    }
+    return allMatch ? 0 : 1;
+}
+
+// The original VisionModule::drawDetections, kept as the reference
+static void legacyDrawDetections(cv::Mat& frame, const std::vector<Detection>& detections, const ClassPolicyTable& policies) {
+    for (const Detection& det : detections) {
+        const uint8_t* bgr = policies[det.classId].color;
+        cv::Scalar color(bgr[0], bgr[1], bgr[2]);
+        int thickness = 2;
+        if (det.box.area() > frame.rows * frame.cols * 0.1) thickness = 4;
+        else if (det.box.area() < frame.rows * frame.cols * 0.01) thickness = 1;
+        cv::rectangle(frame, det.box, color, thickness);
+        std::string text = std::string(det.label()) + " " + std::to_string(static_cast<int>(det.score * 100)) + "%";
+        double fontScale = 0.6;
+        if (det.box.area() > frame.rows * frame.cols * 0.1) fontScale = 1.0;
+        else if (det.box.area() < frame.rows * frame.cols * 0.01) fontScale = 0.4;
+        int baseline = 0;
+        cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, fontScale, 2, &baseline);
+        cv::Point textOrg = cv::Point(det.box.x, std::max(det.box.y - 5, textSize.height + 5));
+        cv::rectangle(frame, cv::Point(textOrg.x - 2, textOrg.y - textSize.height - baseline - 2),
+                      cv::Point(textOrg.x + textSize.width + 2, textOrg.y + baseline + 2), color, cv::FILLED);
+        cv::putText(frame, text, textOrg, cv::FONT_HERSHEY_SIMPLEX, fontScale, cv::Scalar(255, 255, 255), 2);
+    }
+}
+
+static int benchOverlay(int argc, char** argv) {
+    int count = argc > 0 ? std::max(1, std::atoi(argv[0])) : 20;
+    static constexpr int FRAMES = 200;
+    static const char* hud[] = {"FPS: 30", "Objects: 20", "capture queue: 1 deep, 0 dropped",
+                                "detect queue: 0 deep, 3 dropped", "track queue: 1 deep, 0 dropped",
+                                "Command: what is on the desk", "AI: A laptop, a cup and a cell phone."};
+
+    // Detections drift slightly and their scores change every frame, as tracked output does
+    TrackingScene scene(count, 9);
+    std::vector<std::vector<Detection>> frames(FRAMES);
+    std::mt19937 rng(3);
+    for (std::vector<Detection>& detections : frames) {
+        scene.step(detections);
+        for (Detection& det : detections) {
+            det.box.x = det.box.x % 1200;
+            det.box.y = 40 + det.box.y % 640;
+            det.classId = static_cast<int>(rng() % 80);
+            det.score = 0.3f + 0.7f * static_cast<float>(rng() % 1000) / 1000.0f;
+        }
+    }
+
+    ClassPolicyTable policies;
+    OverlayRenderer overlay(policies);
+    cv::Mat background(720, 1280, CV_8UC3, cv::Scalar(40, 40, 40)), frame;
+    int index = 0;
+    auto legacy = [&] {
+        background.copyTo(frame);
+        legacyDrawDetections(frame, frames[index++ % FRAMES], policies);
+        int y = 30;
+        for (const char* line : hud) {
+            cv::putText(frame, line, cv::Point(10, y), cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
+            y += 25;
+        }
+    };
+    auto cached = [&] {
+        background.copyTo(frame);
+        overlay.drawDetections(frame, frames[index++ % FRAMES]);
+        int y = 30;
+        for (const char* line : hud) {
+            overlay.text(frame, line, cv::Point(10, y), 0.6, cv::Scalar(0, 255, 0), 2);
+            y += 25;
+        }
+    };
+    auto copyOnly = [&] { background.copyTo(frame); };
+
+    double copyUs = timeIt(copyOnly, FRAMES);
+    double legacyUs = timeIt(legacy, FRAMES) - copyUs;
+    double cachedUs = timeIt(cached, FRAMES) - copyUs;
+    const GlyphCache& glyphs = overlay.glyphs();
+    std::cout << "detections  putText(us)  cached(us)  speedup  glyph hit rate  strips" << std::endl;
+    std::cout << count << "  " << legacyUs << "  " << cachedUs << "  " << legacyUs / cachedUs << "x  "
+              << 100.0 * glyphs.hits() / std::max<uint64_t>(1, glyphs.hits() + glyphs.misses()) << "%  "
+              << glyphs.size() << std::endl;
+    return 0;
+}
+
+static int benchJpeg(int argc, char** argv) {
+    std::vector<uchar> jpeg;
+    if (argc > 0) {
+        std::ifstream in(argv[0], std::ios::binary);
+        jpeg.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    } else {
+        // Smooth background with solid shapes and mild noise compresses like a
+        // camera frame; pure noise would make every decode entropy-bound
+        cv::Mat scene(720, 1280, CV_8UC3);
+        for (int y = 0; y < scene.rows; y++) {
+            cv::Vec3b* row = scene.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < scene.cols; x++) {
+                row[x] = cv::Vec3b(static_cast<uchar>(x / 5), static_cast<uchar>(y / 3), static_cast<uchar>((x + y) / 8));
+            }
+        }
+        std::mt19937 rng(4);
+        for (int i = 0; i < 40; i++) {
+            cv::Rect box(rng() % 1200, rng() % 660, 20 + rng() % 200, 20 + rng() % 200);
+            cv::rectangle(scene, box, cv::Scalar(rng() % 256, rng() % 256, rng() % 256), cv::FILLED);
+        }
+        cv::Mat noise(scene.size(), CV_8UC3);
+        cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(12));
+        scene += noise;
+        cv::imencode(".jpg", scene, jpeg, {cv::IMWRITE_JPEG_QUALITY, 90});
+    }
+    cv::Size imageSize;
+    if (jpeg.empty() || !JpegDecoder::readSize(jpeg.data(), jpeg.size(), imageSize)) {
+        std::cerr << "jpeg: not a readable JPEG" << std::endl;
+        return 1;
+    }
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+
+    std::cout << imageSize.width << "x" << imageSize.height << ", " << jpeg.size() / 1024 << " KB, "
+              << (JpegDecoder::hasLibjpeg() ? "libjpeg" : "cv::imdecode reduced modes") << std::endl;
+    std::cout << "scale  decode(us)  full+resize(us)  vs. full decode" << std::endl;
+    cv::Mat full, scaled, resized;
+    const double fullUs = timeIt([&] { JpegDecoder::decode(jpeg.data(), jpeg.size(), 1, full); }, iterations);
+    for (int scale : {1, 2, 4}) {
+        const double scaledUs = scale == 1 ? fullUs
+            : timeIt([&] { JpegDecoder::decode(jpeg.data(), jpeg.size(), scale, scaled); }, iterations);
+        const double resizeUs = scale == 1 ? fullUs : timeIt([&] {
+            JpegDecoder::decode(jpeg.data(), jpeg.size(), 1, full);
+            cv::resize(full, resized, JpegDecoder::scaledSize(imageSize, scale), 0, 0, cv::INTER_AREA);
+        }, iterations);
+        std::cout << "1/" << scale << "  " << scaledUs << "  " << resizeUs << "  " << fullUs / scaledUs << "x" << std::endl;
+    }
+    return 0;
+}
+
+static int benchAllocs(int argc, char** argv) {
+    if (argc < 1) {
+        std::cerr << "allocs: model path required" << std::endl;
+        return 1;
+    }
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+    static constexpr int WARMUP = 10;
+
+    // One thread everywhere, so every allocation of a frame lands on this one
+    cv::setNumThreads(0);
+    SessionConfig config;
+    config.intraOpThreads = 1;
+    config.allowSpinning = false;
+    VisionModule vision(argv[0]);
+    vision.setSessionConfig(config);
+    vision.setModelCacheDir("");
+    if (!vision.init()) return 1;
+
+    cv::Mat frame(720, 1280, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    std::vector<Detection> results;
+    for (int i = 0; i < WARMUP; i++) vision.detect(frame, results);
+    uint64_t before = threadAllocations;
+    for (int i = 0; i < frames; i++) vision.detect(frame, results);
+    const double detectAllocs = static_cast<double>(threadAllocations - before) / frames;
+
+    // ORT's own share: the same model run through a bare pre-bound session
+    Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "allocs");
+    Ort::SessionOptions options;
+    options.SetIntraOpNumThreads(1);
+    options.AddConfigEntry("session.intra_op.allow_spinning", "0");
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    Ort::Session session(env, argv[0], options);
+    Ort::AllocatorWithDefaultOptions allocator;
+    Ort::AllocatedStringPtr inputName = session.GetInputNameAllocated(0, allocator);
+    Ort::AllocatedStringPtr outputName = session.GetOutputNameAllocated(0, allocator);
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    std::vector<int64_t> inputShape = {1, 3, 640, 640};
+    std::vector<float> input(3 * 640 * 640, 0.5f);
+    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, input.data(), input.size(),
+                                                             inputShape.data(), inputShape.size());
+    std::vector<int64_t> outputShape = session.GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    const bool staticOutput = std::all_of(outputShape.begin(), outputShape.end(), [](int64_t d) { return d > 0; });
+    std::vector<float> output;
+    Ort::Value outputTensor{nullptr};
+    Ort::IoBinding binding(session);
+    binding.BindInput(inputName.get(), inputTensor);
+    if (staticOutput) {
+        size_t outputSize = 1;
+        for (int64_t d : outputShape) outputSize *= static_cast<size_t>(d);
+        output.resize(outputSize);
+        outputTensor = Ort::Value::CreateTensor<float>(memoryInfo, output.data(), output.size(),
+                                                       outputShape.data(), outputShape.size());
+        binding.BindOutput(outputName.get(), outputTensor);
+    } else {
+        binding.BindOutput(outputName.get(), memoryInfo);
+    }
+    Ort::RunOptions runOptions;
+    for (int i = 0; i < WARMUP; i++) session.Run(runOptions, binding);
+    before = threadAllocations;
+    for (int i = 0; i < frames; i++) session.Run(runOptions, binding);
+    const double runAllocs = static_cast<double>(threadAllocations - before) / frames;
+
+    const double own = detectAllocs - runAllocs;
+    std::cout << "allocations per frame: detect() " << detectAllocs << ", bare Session::Run " << runAllocs
+              << ", VisionModule " << own << (staticOutput ? "" : " (dynamic output shape)") << std::endl;
+    return own > 0.0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " decode [output.bin] | nms [count...] | batch <model.onnx> [maxN] | tiles <model.onnx> [WxH...]"
+                  << " | compare <fp32.onnx> <int8.onnx> <image_dir> [label_dir] | layouts | session <model.onnx> [iterations]"
+                  << " | tracker [count...] | trackcost [count...] | overlay [count]"
+                  << " | jpeg [image.jpg] [iterations] | allocs <model.onnx> [frames]" << std::endl;
+        return 1;
+    }
+
+    std::string name = argv[1];
+    if (name == "decode") return benchDecode(argc - 2, argv + 2);
+    if (name == "nms") return benchNms(argc - 2, argv + 2);
+    if (name == "batch") return benchBatch(argc - 2, argv + 2);
+    if (name == "tiles") return benchTiles(argc - 2, argv + 2);
+    if (name == "compare") return benchCompare(argc - 2, argv + 2);
+    if (name == "layouts") return benchLayouts(argc - 2, argv + 2);
+    if (name == "session") return benchSession(argc - 2, argv + 2);
+    if (name == "tracker") return benchTracker(argc - 2, argv + 2);
+    if (name == "trackcost") return benchTrackCost(argc - 2, argv + 2);
+    if (name == "overlay") return benchOverlay(argc - 2, argv + 2);
+    if (name == "jpeg") return benchJpeg(argc - 2, argv + 2);
+    if (name == "allocs") return benchAllocs(argc - 2, argv + 2);
+
+    std::cerr << "Unknown benchmark: " << name << std::endl;
+    return 1;
+}
@@ -0,0 +1,44 @@
+#include "framepool.h"
+
+FramePool::FramePool(size_t count, const cv::Size& size, int type) : state_(std::make_shared<State>()) {
+    state_->buffers.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        state_->buffers[i].create(size, type);
+        state_->free.push_back(i);
+    }
+    state_->stats.capacity = count;
+}
+
+FrameBuffer FramePool::acquire(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (state_->free.empty()) {
+        state_->stats.waits++;
+        if (!state_->returned.wait_for(lock, timeout, [&] { return !state_->free.empty(); })) return nullptr;
+    }
+    size_t index = state_->free.back();
+    state_->free.pop_back();
+    state_->stats.acquired++;
+
+    // The deleter returns the slot instead of freeing anything
+    std::shared_ptr<State> state = state_;
+    return FrameBuffer(&state_->buffers[index], [state, index](cv::Mat*) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->free.push_back(index);
+        }
+        state->returned.notify_one();
+    });
+}
+
+void FramePool::noteWrite(const FrameBuffer& buffer, const uchar* previousData) {
+    if (buffer->data == previousData) return;
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stats.reallocations++;
+}
+
+FramePoolStats FramePool::stats() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    FramePoolStats stats = state_->stats;
+    stats.available = state_->free.size();
+    return stats;
+}
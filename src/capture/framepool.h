@@ -0,0 +1,49 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A pooled frame: holding it keeps the buffer out of the pool, dropping the
+// last reference hands it back. Copies share the pixels (no deep copy).
+using FrameBuffer = std::shared_ptr<cv::Mat>;
+
+struct FramePoolStats {
+    size_t capacity = 0;
+    size_t available = 0;
+    uint64_t acquired = 0;
+    uint64_t waits = 0;           // acquire() found the pool empty
+    uint64_t reallocations = 0;   // a source wrote a different size/type into a buffer
+};
+
+// Fixed set of frame buffers allocated up front and recycled through the
+// pipeline. Buffers are reference-counted: the capture stage fills one, the
+// packet carrying it moves through detection, tracking and rendering, and the
+// buffer returns to the pool when the last packet referencing it is gone.
+// The pool's bookkeeping is shared with outstanding buffers, so a buffer may
+// outlive the FramePool object.
+class FramePool {
+public:
+    FramePool(size_t count, const cv::Size& size, int type = CV_8UC3);
+
+    // A free buffer, waiting up to timeout for one to come back; nullptr on timeout
+    FrameBuffer acquire(std::chrono::milliseconds timeout);
+
+    // Call after writing into a buffer so size/type changes are counted
+    void noteWrite(const FrameBuffer& buffer, const uchar* previousData);
+
+    FramePoolStats stats() const;
+
+private:
+    struct State {
+        std::vector<cv::Mat> buffers;
+        std::vector<size_t> free;
+        mutable std::mutex mutex;
+        std::condition_variable returned;
+        FramePoolStats stats;
+    };
+    std::shared_ptr<State> state_;
+};
@@ -0,0 +1,221 @@
+#include "framesource.h"
+#include "jpegdecoder.h"
+#include "../argparse.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static constexpr int CAMERA_WIDTH = 1280;
+static constexpr int CAMERA_HEIGHT = 720;
+static constexpr double CAMERA_FPS = 30.0;
+static constexpr int MAX_CAMERA_INDEX = 255;
+
+CameraSource::CameraSource(int index, const cv::Size& size, double fps, bool mjpeg) : index_(index) {
+#if defined(__APPLE__)
+    capture_.open(index, cv::CAP_AVFOUNDATION);
+#else
+    capture_.open(index, cv::CAP_ANY);
+#endif
+    if (!capture_.isOpened()) return;
+    if (mjpeg) {
+        capture_.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    }
+    capture_.set(cv::CAP_PROP_FRAME_WIDTH, size.width);
+    capture_.set(cv::CAP_PROP_FRAME_HEIGHT, size.height);
+    capture_.set(cv::CAP_PROP_FPS, fps);
+    if (mjpeg) {
+        const int mjpg = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+        encoded_ = static_cast<int>(capture_.get(cv::CAP_PROP_FOURCC)) == mjpg &&
+                   capture_.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    }
+}
+
+bool CameraSource::read(cv::Mat& frame) {
+    if (!encoded_) return capture_.read(frame) && !frame.empty();
+    // Decoded straight from the grabbed payload, no copy
+    size_t size = 0;
+    return grabEncoded(size) && JpegDecoder::decode(raw_.ptr(), size, 1, frame);
+}
+
+// With CONVERT_RGB off the backend returns the MJPEG payload as one row of bytes
+bool CameraSource::grabEncoded(size_t& size) {
+    if (!capture_.read(raw_) || raw_.empty()) return false;
+    size = raw_.total() * raw_.elemSize();
+    return true;
+}
+
+bool CameraSource::readEncoded(cv::Mat& buffer, size_t& size) {
+    if (!grabEncoded(size)) return false;
+    if (buffer.empty() || buffer.total() < size) buffer.create(1, static_cast<int>(size), CV_8UC1);
+    std::memcpy(buffer.ptr(), raw_.ptr(), size);
+    return true;
+}
+
+std::string CameraSource::describe() const {
+    return "camera " + std::to_string(index_) + (encoded_ ? " (MJPEG)" : "");
+}
+
+cv::Size CameraSource::frameSize() const {
+    return cv::Size(static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+VideoFileSource::VideoFileSource(const std::string& path, bool loop)
+    : path_(path), loop_(loop), capture_(path) {}
+
+bool VideoFileSource::read(cv::Mat& frame) {
+    if (capture_.read(frame) && !frame.empty()) return true;
+    if (!loop_) return false;
+    capture_.set(cv::CAP_PROP_POS_FRAMES, 0);
+    return capture_.read(frame) && !frame.empty();
+}
+
+cv::Size VideoFileSource::frameSize() const {
+    return cv::Size(static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+ImageDirectorySource::ImageDirectorySource(const std::string& directory, bool loop) : loop_(loop) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        bool jpeg = ext == ".jpg" || ext == ".jpeg";
+        if (jpeg || ext == ".png" || ext == ".bmp") {
+            files_.push_back(entry.path().string());
+            allJpeg_ = allJpeg_ && jpeg;
+        }
+    }
+    std::sort(files_.begin(), files_.end());
+
+    // The first image that decodes sets the output size; with none the
+    // source reports empty()
+    for (const std::string& file : files_) {
+        decoded_ = cv::imread(file);
+        if (decoded_.empty()) {
+            std::cerr << "Cannot decode " << file << ", skipped" << std::endl;
+            continue;
+        }
+        size_ = decoded_.size();
+        break;
+    }
+    if (size_.empty()) files_.clear();
+}
+
+// False at the end of a non-looping sequence
+bool ImageDirectorySource::advance() {
+    if (files_.empty()) return false;
+    if (next_ == files_.size()) {
+        if (!loop_) return false;
+        next_ = 0;
+    }
+    return true;
+}
+
+bool ImageDirectorySource::readEncoded(cv::Mat& buffer, size_t& size) {
+    while (advance()) {
+        std::ifstream in(files_[next_++], std::ios::binary | std::ios::ate);
+        if (!in) continue;
+        size = static_cast<size_t>(in.tellg());
+        if (buffer.empty() || buffer.total() < size) buffer.create(1, static_cast<int>(size), CV_8UC1);
+        in.seekg(0);
+        if (in.read(reinterpret_cast<char*>(buffer.ptr()), static_cast<std::streamsize>(size))) return true;
+    }
+    return false;
+}
+
+bool ImageDirectorySource::read(cv::Mat& frame) {
+    while (advance()) {
+        decoded_ = cv::imread(files_[next_++]);
+        if (decoded_.empty()) continue;
+        if (decoded_.size() == size_) decoded_.copyTo(frame);
+        else cv::resize(decoded_, frame, size_);
+        return true;
+    }
+    return false;
+}
+
+std::string ImageDirectorySource::describe() const {
+    return "images (" + std::to_string(files_.size()) + " files)";
+}
+
+SyntheticSource::SyntheticSource(const cv::Size& size, double fps)
+    : size_(size), fps_(fps), nextFrame_(std::chrono::steady_clock::now()) {
+    background_.create(size, CV_8UC3);
+    cv::randu(background_, cv::Scalar::all(40), cv::Scalar::all(90));
+}
+
+bool SyntheticSource::read(cv::Mat& frame) {
+    if (fps_ > 0.0) {
+        std::this_thread::sleep_until(nextFrame_);
+        nextFrame_ += std::chrono::microseconds(static_cast<int64_t>(1e6 / fps_));
+    }
+    background_.copyTo(frame);
+
+    // Boxes bouncing across the frame at different speeds
+    static constexpr int BOXES = 4;
+    const int side = std::max(16, size_.height / 6);
+    for (int i = 0; i < BOXES; i++) {
+        int spanX = std::max(1, size_.width - side);
+        int spanY = std::max(1, size_.height - side);
+        int64_t tx = static_cast<int64_t>(frameIndex_) * (3 + 2 * i) + i * 97;
+        int64_t ty = static_cast<int64_t>(frameIndex_) * (2 + i) + i * 53;
+        int x = static_cast<int>(tx % (2 * spanX));
+        int y = static_cast<int>(ty % (2 * spanY));
+        if (x >= spanX) x = 2 * spanX - x;
+        if (y >= spanY) y = 2 * spanY - y;
+        cv::rectangle(frame, cv::Rect(x, y, side, side),
+                      cv::Scalar(60 * i % 256, 255 - 50 * i, 40 + 70 * i), cv::FILLED);
+    }
+    frameIndex_++;
+    return true;
+}
+
+std::string SyntheticSource::describe() const {
+    return "synthetic " + std::to_string(size_.width) + "x" + std::to_string(size_.height);
+}
+
+std::unique_ptr<FrameSource> openFrameSource(const std::string& spec, bool preferEncoded) {
+    if (spec == "camera" || spec.rfind("camera:", 0) == 0) {
+        int index = 0;
+        if (spec != "camera" && !parseIntArg(spec.c_str() + 7, 0, MAX_CAMERA_INDEX, index)) {
+            std::cerr << "Invalid camera source '" << spec << "': expected camera:<index> with index 0 to "
+                      << MAX_CAMERA_INDEX << std::endl;
+            return nullptr;
+        }
+        auto camera = std::make_unique<CameraSource>(index, cv::Size(CAMERA_WIDTH, CAMERA_HEIGHT), CAMERA_FPS,
+                                                     preferEncoded);
+        if (!camera->isOpened()) {
+            std::cerr << "Failed to open camera " << index << std::endl;
+            return nullptr;
+        }
+        return camera;
+    }
+    if (spec.rfind("synthetic", 0) == 0) {
+        int width = CAMERA_WIDTH, height = CAMERA_HEIGHT;
+        double fps = CAMERA_FPS;
+        if (spec.size() > 10 && spec[9] == ':') std::sscanf(spec.c_str() + 10, "%dx%d@%lf", &width, &height, &fps);
+        return std::make_unique<SyntheticSource>(cv::Size(std::max(1, width), std::max(1, height)), fps);
+    }
+
+    std::error_code ec;
+    if (std::filesystem::is_directory(spec, ec)) {
+        auto images = std::make_unique<ImageDirectorySource>(spec, true);
+        if (images->empty()) {
+            std::cerr << "No readable images in " << spec << std::endl;
+            return nullptr;
+        }
+        return images;
+    }
+    auto video = std::make_unique<VideoFileSource>(spec, true);
+    if (!video->isOpened()) {
+        std::cerr << "Failed to open video " << spec << std::endl;
+        return nullptr;
+    }
+    return video;
+}
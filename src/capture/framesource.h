@@ -0,0 +1,120 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Where frames come from. read() writes into the caller's Mat, reusing its
+// memory whenever the size and type already match (pool buffers always do
+// after the first frame), so steady-state capture allocates nothing.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // False at end of stream or on a device error
+    virtual bool read(cv::Mat& frame) = 0;
+    // Nominal frame size, used to size the frame pool
+    virtual cv::Size frameSize() const = 0;
+    virtual std::string describe() const = 0;
+
+    // Sources that can hand over undecoded JPEG frames (MJPEG cameras, JPEG
+    // sequences), so the consumer can decode at reduced scale
+    virtual bool supportsEncoded() const { return false; }
+    // Writes the JPEG bytes to the start of buffer (a 1-row CV_8UC1 Mat,
+    // grown if too small) and their count to size
+    virtual bool readEncoded(cv::Mat& buffer, size_t& size) { return false; }
+};
+
+// Live camera through the platform's default backend (AVFoundation on macOS,
+// V4L2 on Linux). With mjpeg, asks for MJPG and raw (unconverted) frames;
+// backends that cannot deliver them fall back to decoded BGR.
+class CameraSource : public FrameSource {
+public:
+    CameraSource(int index, const cv::Size& size, double fps, bool mjpeg = false);
+    bool isOpened() const { return capture_.isOpened(); }
+
+    bool read(cv::Mat& frame) override;
+    cv::Size frameSize() const override;
+    std::string describe() const override;
+
+    bool supportsEncoded() const override { return encoded_; }
+    bool readEncoded(cv::Mat& buffer, size_t& size) override;
+
+private:
+    bool grabEncoded(size_t& size);
+
+    int index_;
+    bool encoded_ = false;
+    cv::VideoCapture capture_;
+    cv::Mat raw_;
+};
+
+// Video file, optionally restarted at the end
+class VideoFileSource : public FrameSource {
+public:
+    VideoFileSource(const std::string& path, bool loop);
+    bool isOpened() const { return capture_.isOpened(); }
+
+    bool read(cv::Mat& frame) override;
+    cv::Size frameSize() const override;
+    std::string describe() const override { return "video " + path_; }
+
+private:
+    std::string path_;
+    bool loop_;
+    cv::VideoCapture capture_;
+};
+
+// Sorted image files from a directory, optionally looped. Images are decoded
+// into a scratch Mat and copied into the caller's buffer, resized to the
+// first image's size if they differ.
+class ImageDirectorySource : public FrameSource {
+public:
+    ImageDirectorySource(const std::string& directory, bool loop);
+    bool empty() const { return files_.empty(); }
+
+    bool read(cv::Mat& frame) override;
+    cv::Size frameSize() const override { return size_; }
+    std::string describe() const override;
+
+    // Only when every file is a JPEG
+    bool supportsEncoded() const override { return allJpeg_; }
+    bool readEncoded(cv::Mat& buffer, size_t& size) override;
+
+private:
+    bool advance();
+    std::vector<std::string> files_;
+    size_t next_ = 0;
+    bool loop_;
+    bool allJpeg_ = true;
+    cv::Size size_;
+    cv::Mat decoded_;
+};
+
+// Generated frames: a textured background with a few moving boxes, paced to
+// fps (0 = as fast as possible). For benchmarks and headless hosts.
+class SyntheticSource : public FrameSource {
+public:
+    SyntheticSource(const cv::Size& size, double fps);
+
+    bool read(cv::Mat& frame) override;
+    cv::Size frameSize() const override { return size_; }
+    std::string describe() const override;
+
+private:
+    cv::Size size_;
+    double fps_;
+    uint64_t frameIndex_ = 0;
+    cv::Mat background_;
+    std::chrono::steady_clock::time_point nextFrame_;
+};
+
+// Opens a source from a command-line spec:
+//   camera[:index]       (default camera:0)
+//   synthetic[:WxH[@fps]]
+//   <directory>          image directory (looped)
+//   <file>               video file (looped)
+// preferEncoded asks cameras for MJPEG so frames can be decoded at reduced
+// scale. Returns nullptr (with a message on stderr) if it cannot be opened.
+std::unique_ptr<FrameSource> openFrameSource(const std::string& spec, bool preferEncoded = false);
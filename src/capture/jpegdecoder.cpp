@@ -0,0 +1,104 @@
+#include "jpegdecoder.h"
+
+#if defined(HAVE_LIBJPEG)
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+
+namespace {
+struct ErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+void onError(j_common_ptr cinfo) {
+    std::longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->jump, 1);
+}
+
+void onMessage(j_common_ptr) {}  // corrupt-data warnings are not fatal; stay quiet
+}
+
+bool JpegDecoder::decode(const uchar* data, size_t size, int scaleDenom, cv::Mat& out) {
+    jpeg_decompress_struct cinfo;
+    ErrorManager error;
+    cinfo.err = jpeg_std_error(&error.base);
+    error.base.error_exit = onError;
+    error.base.output_message = onMessage;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = static_cast<unsigned int>(scaleDenom);
+    cinfo.dct_method = JDCT_IFAST;
+#if defined(JCS_EXTENSIONS)
+    cinfo.out_color_space = JCS_EXT_BGR;  // libjpeg-turbo: no swizzle pass
+#else
+    cinfo.out_color_space = JCS_RGB;
+#endif
+    jpeg_start_decompress(&cinfo);
+
+    out.create(static_cast<int>(cinfo.output_height), static_cast<int>(cinfo.output_width), CV_8UC3);
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = out.ptr<uchar>(static_cast<int>(cinfo.output_scanline));
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+#if !defined(JCS_EXTENSIONS)
+    cv::cvtColor(out, out, cv::COLOR_RGB2BGR);
+#endif
+    return true;
+}
+
+bool JpegDecoder::hasLibjpeg() {
+    return true;
+}
+
+#else
+
+bool JpegDecoder::decode(const uchar* data, size_t size, int scaleDenom, cv::Mat& out) {
+    int flags = cv::IMREAD_COLOR;
+    if (scaleDenom == 2) flags = cv::IMREAD_REDUCED_COLOR_2;
+    else if (scaleDenom == 4) flags = cv::IMREAD_REDUCED_COLOR_4;
+    else if (scaleDenom == 8) flags = cv::IMREAD_REDUCED_COLOR_8;
+    cv::Mat decoded = cv::imdecode(cv::Mat(1, static_cast<int>(size), CV_8UC1, const_cast<uchar*>(data)), flags);
+    if (decoded.empty()) return false;
+    decoded.copyTo(out);
+    return true;
+}
+
+bool JpegDecoder::hasLibjpeg() {
+    return false;
+}
+
+#endif
+
+// Walks the marker segments up to the first start-of-frame
+bool JpegDecoder::readSize(const uchar* data, size_t size, cv::Size& imageSize) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) return false;
+        uchar marker = data[pos + 1];
+        if (marker == 0xFF) {  // fill byte
+            pos++;
+            continue;
+        }
+        size_t length = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+        // SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (pos + 9 > size) return false;
+            imageSize.height = (data[pos + 5] << 8) | data[pos + 6];
+            imageSize.width = (data[pos + 7] << 8) | data[pos + 8];
+            return imageSize.width > 0 && imageSize.height > 0;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+
+// JPEG decode with DCT-domain downscaling. libjpeg(-turbo) can produce a
+// 1/2, 1/4 or 1/8 scale image by skipping the high-frequency coefficients,
+// which is far cheaper than a full decode followed by a resize. Built with
+// HAVE_LIBJPEG the decoder writes BGR rows straight into the output Mat;
+// otherwise it falls back to cv::imdecode's IMREAD_REDUCED_* modes.
+class JpegDecoder {
+public:
+    // Decodes at 1/scaleDenom (1, 2, 4 or 8) into out, reusing its memory
+    // when the size already matches. False on corrupt data.
+    static bool decode(const uchar* data, size_t size, int scaleDenom, cv::Mat& out);
+
+    // Full-resolution size from the SOF header, without decoding
+    static bool readSize(const uchar* data, size_t size, cv::Size& imageSize);
+
+    // Size of a 1/scaleDenom decode (libjpeg rounds up)
+    static cv::Size scaledSize(const cv::Size& imageSize, int scaleDenom) {
+        return cv::Size((imageSize.width + scaleDenom - 1) / scaleDenom, (imageSize.height + scaleDenom - 1) / scaleDenom);
+    }
+
+    // Whether decode() uses libjpeg directly
+    static bool hasLibjpeg();
+};
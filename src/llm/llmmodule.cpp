@@ -1,5 +1,7 @@
 #include "llmmodule.h"
+#include "../vision/coco_labels.h"
 #include <llama.h>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -213,7 +215,7 @@ generation_complete:
     return response;
 }
 
-std::string LLMModule::buildContextPrompt(const std::vector<std::string>& detectedObjects,
+std::string LLMModule::buildContextPrompt(const std::vector<int>& detectedClassIds,
                                          const std::string& userCommand) {
     std::ostringstream prompt;
     
@@ -223,16 +225,25 @@ std::string LLMModule::buildContextPrompt(const std::vector<std::string>& detect
     prompt << "Actions: open_url, notify, none\n";
     prompt << "<|eot_id|><|start_header_id|>user<|end_header_id|>\n\n";
     
-    // Visual context
+    // Visual context, limited to the watched classes
+    if (!sceneClasses_.empty()) {
+        prompt << "Watched objects: ";
+        for (size_t i = 0; i < sceneClasses_.size(); i++) {
+            prompt << (i ? ", " : "") << cocoLabel(sceneClasses_[i]);
+        }
+        prompt << "\n";
+    }
     prompt << "Scene: ";
-    if (detectedObjects.empty()) {
-        prompt << "empty";
-    } else {
-        for (size_t i = 0; i < detectedObjects.size(); i++) {
-            prompt << detectedObjects[i];
-            if (i < detectedObjects.size() - 1) prompt << ", ";
+    bool anyObject = false;
+    for (int classId : detectedClassIds) {
+        if (!sceneClasses_.empty() &&
+            std::find(sceneClasses_.begin(), sceneClasses_.end(), classId) == sceneClasses_.end()) {
+            continue;
         }
+        prompt << (anyObject ? ", " : "") << cocoLabel(classId);
+        anyObject = true;
     }
+    if (!anyObject) prompt << "empty";
     prompt << "\n";
     
     // User command
@@ -27,15 +27,20 @@ public:
     // Generate response from prompt
     LLMResponse generate(const std::string& prompt, int maxTokens = 256);
     
-    // Build structured prompt from vision + audio context
-    std::string buildContextPrompt(const std::vector<std::string>& detectedObjects,
+    // Build structured prompt from vision + audio context (detected COCO class ids)
+    std::string buildContextPrompt(const std::vector<int>& detectedClassIds,
                                    const std::string& userCommand);
+
+    // Restrict the scene context to these COCO class ids (empty = all). The
+    // prompt then also tells the model which classes are being watched.
+    void setSceneClasses(const std::vector<int>& classIds) { sceneClasses_ = classIds; }
     
     // Check if model is loaded
     bool isLoaded() const { return model_ != nullptr && ctx_ != nullptr; }
     
 private:
     std::string modelPath_;
+    std::vector<int> sceneClasses_;
     llama_model* model_;
     llama_context* ctx_;
     llama_sampler* sampler_;
@@ -1,107 +1,189 @@
 #include "vision/visionmodule.h"
+#include "vision/sessiontuner.h"
 #include "../include/audio.h"
 #include "llm/llmmodule.h"
+#include "tracking/tracker.h"
+#include "tracking/flowpropagator.h"
+#include "pipeline/pipeline.h"
+#include "capture/framesource.h"
+#include "capture/framepool.h"
+#include "capture/jpegdecoder.h"
+#include "render/overlayrenderer.h"
+#include "render/trackinterpolator.h"
+#include "output/detectionstream.h"
+#include "argparse.h"
 #include <opencv2/opencv.hpp>
 #include <chrono>
-#include <map>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
 
-// Simple tracking structure
-struct TrackedObject {
-    cv::Rect box;
-    std::string label;
-    float confidence;
-    int missedFrames;
-    int id;
-};
+// Set by SIGINT/SIGTERM in headless mode, where there is no ESC key
+static volatile std::sig_atomic_t stopRequested = 0;
 
-class SimpleTracker {
-private:
-    std::map<int, TrackedObject> trackedObjects;
-    int nextId = 0;
-    const float IOU_THRESHOLD = 0.3f;
-    const int MAX_MISSED_FRAMES = 5;
-    
-    float calculateIOU(const cv::Rect& a, const cv::Rect& b) {
-        float inter = (a & b).area();
-        float uni = a.area() + b.area() - inter;
-        return (uni > 0) ? inter / uni : 0.0f;
-    }
-    
-public:
-    std::vector<Detection> updateTracks(const std::vector<Detection>& newDetections) {
-        std::vector<Detection> smoothedDetections;
-        std::vector<bool> matched(newDetections.size(), false);
-        
-        // Update existing tracks
-        for (auto& [id, track] : trackedObjects) {
-            track.missedFrames++;
-            
-            // Try to match with new detections
-            float bestIOU = 0;
-            int bestMatch = -1;
-            
-            for (size_t i = 0; i < newDetections.size(); i++) {
-                if (matched[i] || newDetections[i].label != track.label) continue;
-                
-                float iou = calculateIOU(track.box, newDetections[i].box);
-                if (iou > IOU_THRESHOLD && iou > bestIOU) {
-                    bestIOU = iou;
-                    bestMatch = static_cast<int>(i);
-                }
-            }
-            
-            if (bestMatch >= 0) {
-                // Smooth the bounding box (simple averaging)
-                const auto& det = newDetections[bestMatch];
-                track.box.x = static_cast<int>(0.7f * track.box.x + 0.3f * det.box.x);
-                track.box.y = static_cast<int>(0.7f * track.box.y + 0.3f * det.box.y);
-                track.box.width = static_cast<int>(0.7f * track.box.width + 0.3f * det.box.width);
-                track.box.height = static_cast<int>(0.7f * track.box.height + 0.3f * det.box.height);
-                
-                track.confidence = det.score;
-                track.missedFrames = 0;
-                matched[bestMatch] = true;
-                
-                smoothedDetections.push_back({track.label, track.confidence, track.box});
-            }
-        }
-        
-        // Remove lost tracks
-        auto it = trackedObjects.begin();
-        while (it != trackedObjects.end()) {
-            if (it->second.missedFrames > MAX_MISSED_FRAMES) {
-                it = trackedObjects.erase(it);
-            } else {
-                ++it;
+int main(int argc, char** argv) {
+    // Command line options
+    std::string classPolicyPath;
+    std::string sourceSpec = "camera:0";
+    int reducedDecode = 1;
+    ClassFilter classFilter;
+    std::string modelCacheDir = "ort_cache";
+    SessionConfig sessionConfig;
+    bool sessionAutotune = false;
+    size_t detectorSessions = 1;
+    std::string visionModelPath = "/Users/gaurangjindal/Desktop/multimodal-agent-cpp/models/yolov8n.onnx";
+    bool motionGateEnabled = true;
+    int detectInterval = 1;
+    bool flowEnabled = false;
+    bool decoupledRender = true;
+    bool headless = false;
+    std::string detectionsOut;
+    MotionGateConfig motionGateConfig;
+    RoiSchedulerConfig roiConfig;
+    bool roiEnabled = false;
+    bool tiledInference = false;
+    ResolutionControllerConfig resolutionConfig;
+    bool resolutionControl = false;
+    auto usage = [&] {
+        std::cerr << "Usage: " << argv[0] << " [--source <camera[:N]|synthetic[:WxH[@fps]]|dir|video>] [--reduced-decode <2|4>] [--model <yolo.onnx>] [--model-cache <dir> | --no-model-cache]"
+                  << " [--ort-intra-threads <n>] [--ort-inter-threads <n>] [--ort-no-spin] [--ort-parallel]"
+                  << " [--ort-no-mem-pattern] [--ort-no-arena] [--ort-ep <provider>] [--ort-autotune] [--sessions <n>]"
+                  << " [--class-policy <file>] [--classes <name,...>] [--detect-interval <frames>] [--flow] [--no-decoupled-render]"
+                  << " [--headless] [--detections-out <file:path|pipe:path|unix:path>] [--no-motion-gate]"
+                  << " [--max-staleness-ms <ms>] [--motion-threshold <fraction>]"
+                  << " [--roi-keyframe-interval <frames>] [--roi-margin <fraction>] [--tiled]"
+                  << " [--frame-budget-ms <ms>]" << std::endl;
+    };
+    // Prints what an option expects plus the usage line; returns main's error code
+    auto invalid = [&](const std::string& option, const char* expected) {
+        std::cerr << option << " takes " << expected << std::endl;
+        usage();
+        return -1;
+    };
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--class-policy" && i + 1 < argc) {
+            classPolicyPath = argv[++i];
+        } else if (arg == "--source" && i + 1 < argc) {
+            sourceSpec = argv[++i];  // camera[:N], synthetic[:WxH[@fps]], image directory or video file
+        } else if (arg == "--reduced-decode" && i + 1 < argc) {
+            // 2 or 4: DCT-scaled JPEG decode for the detector
+            if (!parseIntArg(argv[++i], 1, 4, reducedDecode) || reducedDecode == 3) return invalid(arg, "1, 2 or 4");
+        } else if (arg == "--classes" && i + 1 < argc) {
+            if (!classFilter.parse(argv[++i])) return -1;
+        } else if (arg == "--model" && i + 1 < argc) {
+            visionModelPath = argv[++i];  // e.g. the INT8 model from the quantize_model target
+        } else if (arg == "--model-cache" && i + 1 < argc) {
+            modelCacheDir = argv[++i];
+        } else if (arg == "--no-model-cache") {
+            modelCacheDir.clear();
+        } else if (arg == "--ort-intra-threads" && i + 1 < argc) {
+            if (!parseIntArg(argv[++i], 0, 1024, sessionConfig.intraOpThreads)) return invalid(arg, "a thread count from 0 (ORT default) to 1024");
+        } else if (arg == "--ort-inter-threads" && i + 1 < argc) {
+            if (!parseIntArg(argv[++i], 0, 1024, sessionConfig.interOpThreads)) return invalid(arg, "a thread count from 0 (ORT default) to 1024");
+        } else if (arg == "--ort-no-spin") {
+            sessionConfig.allowSpinning = false;
+        } else if (arg == "--ort-parallel") {
+            sessionConfig.parallelExecution = true;
+        } else if (arg == "--ort-no-mem-pattern") {
+            sessionConfig.memoryPattern = false;
+        } else if (arg == "--ort-no-arena") {
+            sessionConfig.cpuArena = false;
+        } else if (arg == "--ort-ep" && i + 1 < argc) {
+            sessionConfig.providers.push_back(argv[++i]);  // e.g. XNNPACK; repeatable
+        } else if (arg == "--sessions" && i + 1 < argc) {
+            int sessions = 0;
+            if (!parseIntArg(argv[++i], 1, 64, sessions)) return invalid(arg, "a session count from 1 to 64");
+            detectorSessions = static_cast<size_t>(sessions);
+        } else if (arg == "--ort-autotune") {
+            sessionAutotune = true;
+        } else if (arg == "--detect-interval" && i + 1 < argc) {
+            // e.g. 4: YOLO at ~7 Hz on a 30 FPS camera
+            if (!parseIntArg(argv[++i], 1, 1000, detectInterval)) return invalid(arg, "a frame count from 1 to 1000");
+        } else if (arg == "--flow") {
+            flowEnabled = true;
+        } else if (arg == "--no-decoupled-render") {
+            decoupledRender = false;  // render only frames that went through detection and tracking
+        } else if (arg == "--headless") {
+            headless = true;  // no window, no drawing, no full-resolution decode
+        } else if (arg == "--detections-out" && i + 1 < argc) {
+            detectionsOut = argv[++i];  // file:<path>, pipe:<path> or unix:<path>
+        } else if (arg == "--no-motion-gate") {
+            motionGateEnabled = false;
+        } else if (arg == "--max-staleness-ms" && i + 1 < argc) {
+            int staleness = 0;
+            if (!parseIntArg(argv[++i], 0, 3600000, staleness)) return invalid(arg, "milliseconds from 0 to 3600000");
+            motionGateConfig.maxStaleness = std::chrono::milliseconds(staleness);
+        } else if (arg == "--motion-threshold" && i + 1 < argc) {
+            double fraction = 0.0;
+            if (!parseDoubleArg(argv[++i], 0.0, 1.0, fraction)) return invalid(arg, "a changed-pixel fraction from 0 to 1");
+            motionGateConfig.changedFraction = static_cast<float>(fraction);
+        } else if (arg == "--roi-keyframe-interval" && i + 1 < argc) {
+            if (!parseIntArg(argv[++i], 1, 10000, roiConfig.keyframeInterval)) return invalid(arg, "a frame count from 1 to 10000");
+            roiEnabled = roiConfig.keyframeInterval > 1;
+        } else if (arg == "--frame-budget-ms" && i + 1 < argc) {
+            if (!parseDoubleArg(argv[++i], 1.0, 10000.0, resolutionConfig.budgetMs)) {
+                return invalid(arg, "a per-run budget from 1 to 10000 ms");
             }
+            resolutionControl = true;
+        } else if (arg == "--tiled") {
+            tiledInference = true;
+        } else if (arg == "--roi-margin" && i + 1 < argc) {
+            double margin = 0.0;
+            if (!parseDoubleArg(argv[++i], 0.0, 4.0, margin)) return invalid(arg, "a box-size fraction from 0 to 4");
+            roiConfig.roiMargin = static_cast<float>(margin);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            usage();
+            return -1;
         }
-        
-        // Add new tracks for unmatched detections
-        for (size_t i = 0; i < newDetections.size(); i++) {
-            if (!matched[i]) {
-                TrackedObject newTrack;
-                newTrack.box = newDetections[i].box;
-                newTrack.label = newDetections[i].label;
-                newTrack.confidence = newDetections[i].score;
-                newTrack.missedFrames = 0;
-                newTrack.id = nextId++;
-                
-                trackedObjects[newTrack.id] = newTrack;
-                smoothedDetections.push_back(newDetections[i]);
-            }
+    }
+
+    // Startup self-benchmark: try thread/spinning/EP combinations, keep the fastest
+    if (sessionAutotune) {
+        std::cout << "Tuning vision session options..." << std::endl;
+        std::vector<SessionTuningResult> tuning;
+        if (!tuneSession(visionModelPath, defaultSessionCandidates(sessionConfig), 20, tuning, sessionConfig)) {
+            std::cerr << "Session tuning failed, keeping the configured options" << std::endl;
         }
-        
-        return smoothedDetections;
     }
-};
 
-int main() {
+    // Several sessions split the cores between them unless told otherwise
+    if (detectorSessions > 1 && sessionConfig.intraOpThreads == 0) {
+        sessionConfig.intraOpThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency() / detectorSessions));
+    }
+    auto configureVision = [&](VisionModule& module) {
+        module.setSessionConfig(sessionConfig);
+        module.setModelCacheDir(modelCacheDir);
+        if (!classPolicyPath.empty() && !module.loadClassPolicies(classPolicyPath)) return false;
+        if (!classFilter.empty()) module.setClassFilter(classFilter);  // overrides a policy-file list
+        return true;
+    };
+
     // Initialize Vision Module
-    VisionModule vision("/Users/gaurangjindal/Desktop/multimodal-agent-cpp/models/yolov8n.onnx");
+    std::unique_ptr<DetectorPool> detectorPool;
+    if (detectorSessions > 1) detectorPool = std::make_unique<DetectorPool>(visionModelPath);
+    VisionModule vision(visionModelPath);
+    if (!configureVision(vision)) {
+        return -1;
+    }
+    if (detectorPool) vision.setPrepackedWeights(detectorPool->prepackedWeights());
     if (!vision.init()) {
         std::cerr << "Failed to initialize vision module" << std::endl;
         return -1;
     }
+    // Pool sessions copy the policies the primary parsed instead of re-reading the file
+    auto configureSession = [&](VisionModule& module) {
+        module.setSessionConfig(sessionConfig);
+        module.setModelCacheDir(modelCacheDir);
+        module.setClassPolicies(vision.classPolicies());
+        return true;
+    };
+    if (detectorPool && !detectorPool->init(vision, detectorSessions, configureSession)) {
+        return -1;
+    }
 
     // Initialize Audio Module
     AudioModule audio("/Users/gaurangjindal/Desktop/multimodal-agent-cpp/models/ggml-small.en.bin");
@@ -117,10 +199,12 @@ int main() {
         return -1;
     }
 
+    llm.setSceneClasses(vision.classFilter().ids());
+
     // Set up transcript callback with LLM integration
     std::string latestCommand;
     std::string latestLLMResponse;
-    std::vector<std::string> currentDetections;
+    std::vector<int> currentDetections;  // class ids, resolved to labels by the LLM prompt builder
     
     audio.setTranscriptCallback([&latestCommand, &latestLLMResponse, &llm, &currentDetections](const std::string& transcript) {
         std::cout << "\n🎤 Voice Command: " << transcript << "\n" << std::endl;
@@ -145,20 +229,78 @@ int main() {
     // Start audio listening
     audio.startListening();
 
-    // Open camera
-    cv::VideoCapture cap(0, cv::CAP_AVFOUNDATION);
-    if (!cap.isOpened()) {
-        std::cerr << "Failed to open camera" << std::endl;
+    // Open the frame source and the buffers it captures into
+    std::unique_ptr<FrameSource> source = openFrameSource(sourceSpec, reducedDecode > 1);
+    if (!source) {
         return -1;
     }
-    
-    // Set camera properties
-    cap.set(cv::CAP_PROP_FRAME_WIDTH, 1280);
-    cap.set(cv::CAP_PROP_FRAME_HEIGHT, 720);
-    cap.set(cv::CAP_PROP_FPS, 30);
+    if (reducedDecode > 1 && !source->supportsEncoded()) {
+        std::cerr << "Reduced-scale decode needs an MJPEG camera or a JPEG sequence; decoding in full" << std::endl;
+        reducedDecode = 1;
+    }
+    // Reduced decode: the pool holds detector-scale frames, JPEG bytes live in
+    // a second pool until the render stage decodes them at full resolution
+    const size_t framesInFlight = VisionPipeline::FRAMES_IN_FLIGHT + 2 * detectorSessions;
+    const cv::Size captureSize = source->frameSize();
+    FramePool framePool(framesInFlight, JpegDecoder::scaledSize(captureSize, reducedDecode));
+    FramePool encodedPool(reducedDecode > 1 ? framesInFlight : 0, cv::Size(captureSize.width * captureSize.height / 2, 1), CV_8UC1);
+    cv::Mat displayFrame;
+    std::cout << "Frame source: " << source->describe()
+              << (reducedDecode > 1 ? " (detector decode at 1/" + std::to_string(reducedDecode) + ")" : "") << std::endl;
 
+    // Capture, detection and tracking run on their own threads; this loop is
+    // the render stage
     SimpleTracker tracker;
-    cv::Mat frame;
+    tracker.setClassFilter(vision.classFilter());
+    VisionPipeline pipeline(*source, framePool, vision, tracker);
+    MotionGate motionGate(motionGateConfig);
+    if (motionGateEnabled) pipeline.setMotionGate(&motionGate);
+    pipeline.setTiledInference(tiledInference);
+    pipeline.setDetectInterval(detectInterval);
+    pipeline.setDisplayTap(decoupledRender && !headless);
+    FlowPropagator flow;
+    if (flowEnabled) pipeline.setFlowPropagator(&flow);
+    if (reducedDecode > 1) {
+        pipeline.setReducedDecode(reducedDecode, &encodedPool);
+        if (roiEnabled) {
+            std::cerr << "ROI inference works on full-resolution frames; ignored with --reduced-decode" << std::endl;
+            roiEnabled = false;
+        }
+    }
+    if (detectorPool) {
+        if (resolutionControl || roiEnabled) {
+            std::cerr << "Resolution control and ROI inference need a single session; ignored with --sessions" << std::endl;
+            resolutionControl = roiEnabled = false;
+        }
+        pipeline.setDetectorPool(detectorPool.get());
+    }
+    ResolutionController resolutionController(resolutionConfig);
+    if (resolutionControl) {
+        if (!vision.supportsVariableInput()) {
+            std::cerr << "Resolution control needs a model with dynamic input size; staying at 640" << std::endl;
+        } else {
+            pipeline.setResolutionController(&resolutionController);
+        }
+    }
+    RoiScheduler roiScheduler(roiConfig);
+    if (roiEnabled) {
+        if (!vision.supportsVariableInput()) {
+            std::cerr << "ROI inference needs a model with dynamic input size; running keyframes only" << std::endl;
+        }
+        pipeline.setRoiScheduler(&roiScheduler);
+    }
+    FramePacket packet;
+    OverlayRenderer overlay(vision.classPolicies());
+    TrackSnapshot snapshot;
+    TrackInterpolator interpolator;
+
+    // Per-frame detections for other processes; a unix socket also carries
+    // the commands that replace the keyboard in headless mode
+    DetectionStream detectionStream;
+    if (!detectionsOut.empty()) {
+        if (!detectionStream.open(detectionsOut)) return -1;
+        std::cout << "Streaming detections to " << detectionStream.describe() << std::endl;
+    }
     
     // Performance monitoring
     auto lastTime = std::chrono::high_resolution_clock::now();
@@ -166,30 +308,101 @@ int main() {
     float avgFPS = 0;
     
     std::cout << "\n=== Multimodal Agent Running ===" << std::endl;
-    std::cout << "Press ESC to quit, 's' to save screenshot" << std::endl;
-    std::cout << "🎤 Press SPACE to START recording, press SPACE again to STOP & transcribe" << std::endl;
-    std::cout << "Speak commands and they will appear on screen\n" << std::endl;
+    if (headless) {
+        std::cout << "Headless: Ctrl-C to quit; socket commands: record, stop, dump, quit\n" << std::endl;
+        std::signal(SIGINT, [](int) { stopRequested = 1; });
+        std::signal(SIGTERM, [](int) { stopRequested = 1; });
+    } else {
+        std::cout << "Press ESC to quit, 's' to save screenshot, 'o' to record the raw YOLO output" << std::endl;
+        std::cout << "🎤 Press SPACE to START recording, press SPACE again to STOP & transcribe" << std::endl;
+        std::cout << "Speak commands and they will appear on screen\n" << std::endl;
+    }
     
     bool isRecording = false;
+    auto toggleRecording = [&] {
+        if (!isRecording) {
+            audio.startRecording();
+            isRecording = true;
+        } else {
+            audio.stopRecording();
+            isRecording = false;
+        }
+    };
+    // Written by the detect stage from the next inferred frame
+    auto saveYoloOutput = [&] { pipeline.requestOutputDump("yolo_output.bin"); };
+    auto lastLog = std::chrono::steady_clock::now();
+    pipeline.start();
     
-    while (true) {
-        cap >> frame;
-        if (frame.empty()) break;
-        
-        // Run detection
-        auto detections = vision.detect(frame);
-        
-        // Apply tracking for smoother results
-        auto smoothedDetections = tracker.updateTracks(detections);
+    while (pipeline.running() && !stopRequested) {
+        // Socket commands stand in for the keys below
+        StreamCommand command;
+        bool quit = false;
+        while (detectionStream.nextCommand(command)) {
+            switch (command) {
+                case StreamCommand::StartRecording: if (!isRecording) toggleRecording(); break;
+                case StreamCommand::StopRecording: if (isRecording) toggleRecording(); break;
+                case StreamCommand::SaveOutput: saveYoloOutput(); break;
+                case StreamCommand::Quit: quit = true; break;
+            }
+        }
+        if (quit) break;
+
+        bool haveFrame = decoupledRender && !headless ? pipeline.nextDisplayFrame(packet, std::chrono::milliseconds(100))
+                                                      : pipeline.nextFrame(packet, std::chrono::milliseconds(100));
+        if (!haveFrame) {
+            if (!headless && cv::waitKey(1) == 27) break;  // keep the window responsive while waiting
+            continue;
+        }
+        if (headless) {
+            // Boxes are already in full-frame coordinates; the pixels are not needed
+            detectionStream.publish(packet.sequence, packet.captured, packet.inferred, packet.tracked);
+            currentDetections.clear();
+            for (const auto& det : packet.tracked) currentDetections.push_back(det.classId);
+
+            frameCount++;
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastLog > std::chrono::seconds(10)) {
+                float fps = frameCount / std::chrono::duration<float>(now - lastLog).count();
+                DetectionStreamStats out = detectionStream.stats();
+                std::cout << "Headless: " << static_cast<int>(fps) << " FPS, " << packet.tracked.size() << " objects";
+                if (!detectionsOut.empty()) {
+                    std::cout << ", stream " << out.frames << " frames in " << out.batches << " writes, "
+                              << out.dropped << " dropped" << (out.connected ? "" : " (no reader)");
+                }
+                std::cout << std::endl;
+                frameCount = 0;
+                lastLog = now;
+            }
+            continue;
+        }
+        // Full-resolution decode happens here, only for frames that get displayed
+        if (!packet.decodeFullFrame(displayFrame)) continue;
+        if (decoupledRender) {
+            // The tap shares its pixels with the detect and track stages,
+            // which are still reading them: draw on a copy
+            if (packet.frame.data != displayFrame.data) {
+                packet.frame.copyTo(displayFrame);
+                packet.frame = displayFrame;
+            }
+            // Frame straight from capture: tracks from the latest tracker
+            // output, moved to this frame's capture time
+            if (pipeline.latestTracks(snapshot)) interpolator.push(snapshot);
+            interpolator.boxesAt(packet.captured, packet.tracked);
+            packet.inferred = interpolator.latest().inferred;
+            packet.mode = interpolator.latest().mode;
+        }
+        detectionStream.publish(packet.sequence, packet.captured, packet.inferred, packet.tracked);
+        cv::Mat& frame = packet.frame;
+        const std::vector<Detection>& smoothedDetections = packet.tracked;
         
         // Update current detections for LLM context
         currentDetections.clear();
         for (const auto& det : smoothedDetections) {
-            currentDetections.push_back(det.label);
+            currentDetections.push_back(det.classId);
         }
         
         // Draw detections
-        vision.drawDetections(frame, smoothedDetections);
+        overlay.drawDetections(frame, smoothedDetections);
         
         // Calculate and display FPS
         frameCount++;
@@ -204,16 +417,58 @@ int main() {
         
         // Display FPS
         std::string fpsText = "FPS: " + std::to_string(static_cast<int>(avgFPS));
-        cv::putText(frame, fpsText, cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2);
+        overlay.text(frame, fpsText, cv::Point(10, 30), 1.0, cv::Scalar(0, 255, 0), 2);
         
         // Display detection count
         std::string countText = "Objects: " + std::to_string(smoothedDetections.size());
-        cv::putText(frame, countText, cv::Point(10, 70), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2);
+        overlay.text(frame, countText, cv::Point(10, 70), 1.0, cv::Scalar(0, 255, 0), 2);
+
+        // Display pipeline queue depth and drop counters
+        int statsY = 30;
+        for (const QueueStats& q : pipeline.stats()) {
+            std::string queueText = std::string(q.name) + " queue: " + std::to_string(q.depth) +
+                                    " deep, " + std::to_string(q.drops) + " dropped";
+            overlay.text(frame, queueText, cv::Point(frame.cols - 330, statsY), 0.5, cv::Scalar(0, 255, 0), 1);
+            statsY += 20;
+        }
+        if (motionGateEnabled) {
+            MotionGateStats gate = pipeline.motionGateStats();
+            int percent = gate.frames ? static_cast<int>(100 * gate.inferences / gate.frames) : 0;
+            std::string gateText = "inference on " + std::to_string(percent) + "% of frames" +
+                                   (packet.inferred ? "" : " (static)");
+            overlay.text(frame, gateText, cv::Point(frame.cols - 330, statsY), 0.5, cv::Scalar(0, 255, 0), 1);
+            statsY += 20;
+        }
+        if (resolutionControl) {
+            ResolutionControllerStats res = pipeline.resolutionStats();
+            std::string resText = "input " + std::to_string(res.inputSize) + "px, run " +
+                                  std::to_string(static_cast<int>(res.smoothedMs)) + " ms";
+            overlay.text(frame, resText, cv::Point(frame.cols - 330, statsY), 0.5, cv::Scalar(0, 255, 0), 1);
+            statsY += 20;
+        }
+        if (roiEnabled) {
+            RoiSchedulerStats roi = pipeline.roiSchedulerStats();
+            uint64_t pixels = roi.keyframePixels + roi.roiPixels;
+            uint64_t keyframeOnlyPixels = (roi.keyframes + roi.roiFrames) * 640ull * 640ull;
+            int saved = keyframeOnlyPixels ? static_cast<int>(100 - 100 * pixels / keyframeOnlyPixels) : 0;
+            std::string roiText = std::string(packet.mode == InferenceMode::Roi ? "ROI" : "keyframe") +
+                                  ": " + std::to_string(roi.roiFrames) + " roi / " + std::to_string(roi.keyframes) +
+                                  " key, " + std::to_string(saved) + "% pixels saved";
+            overlay.text(frame, roiText, cv::Point(frame.cols - 330, statsY), 0.5, cv::Scalar(0, 255, 0), 1);
+            statsY += 20;
+        }
+        if (flowEnabled) {
+            FlowStats flowStats = pipeline.flowStats();
+            char flowText[96];
+            std::snprintf(flowText, sizeof(flowText), "flow %.1f ms, drift %.2f diag, IoU %.2f",
+                          flowStats.meanMs(), flowStats.meanDrift(), flowStats.meanIou());
+            overlay.text(frame, flowText, cv::Point(frame.cols - 330, statsY), 0.5, cv::Scalar(0, 255, 0), 1);
+        }
 
         // Display audio status with level meter
         std::string audioStatus = audio.isRecording() ? "🔴 RECORDING (press SPACE to stop)" : "🎤 Ready (press SPACE to record)";
         cv::Scalar audioColor = audio.isRecording() ? cv::Scalar(0, 0, 255) : cv::Scalar(0, 255, 0);
-        cv::putText(frame, audioStatus, cv::Point(10, 110), cv::FONT_HERSHEY_SIMPLEX, 0.6, audioColor, 2);
+        overlay.text(frame, audioStatus, cv::Point(10, 110), 0.6, audioColor, 2);
         
         // Show audio level meter when recording
         if (audio.isRecording()) {
@@ -229,7 +484,7 @@ int main() {
             
             // Show level value
             std::string levelText = "Level: " + std::to_string(static_cast<int>(level * 100));
-            cv::putText(frame, levelText, cv::Point(420, 155), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
+            overlay.text(frame, levelText, cv::Point(420, 155), 0.5, cv::Scalar(255, 255, 255), 1);
         }
         
         // Display latest command
@@ -237,13 +492,13 @@ int main() {
             std::string cmdText = "Command: " + latestCommand;
             // Add background for better readability
             int baseline = 0;
-            cv::Size textSize = cv::getTextSize(cmdText, cv::FONT_HERSHEY_SIMPLEX, 0.7, 2, &baseline);
+            cv::Size textSize = overlay.textSize(cmdText, 0.7, 2, &baseline);
             cv::rectangle(frame, 
                          cv::Point(10, frame.rows - 90),
                          cv::Point(20 + textSize.width, frame.rows - 90 + textSize.height + 10),
                          cv::Scalar(0, 0, 0), cv::FILLED);
-            cv::putText(frame, cmdText, cv::Point(15, frame.rows - 70), 
-                       cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 0), 2);
+            overlay.text(frame, cmdText, cv::Point(15, frame.rows - 70), 
+                       0.7, cv::Scalar(255, 255, 0), 2);
         }
         
         // Display LLM response
@@ -255,13 +510,13 @@ int main() {
             }
             
             int baseline = 0;
-            cv::Size textSize = cv::getTextSize(llmText, cv::FONT_HERSHEY_SIMPLEX, 0.6, 2, &baseline);
+            cv::Size textSize = overlay.textSize(llmText, 0.6, 2, &baseline);
             cv::rectangle(frame, 
                          cv::Point(10, frame.rows - 50),
                          cv::Point(20 + textSize.width, frame.rows - 50 + textSize.height + 10),
                          cv::Scalar(0, 0, 0), cv::FILLED);
-            cv::putText(frame, llmText, cv::Point(15, frame.rows - 30), 
-                       cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 255), 2);
+            overlay.text(frame, llmText, cv::Point(15, frame.rows - 30), 
+                       0.6, cv::Scalar(0, 255, 255), 2);
         }
 
         cv::imshow("Multimodal Agent", frame);
@@ -270,13 +525,7 @@ int main() {
         
         // Toggle recording with spacebar
         if (key == ' ' || key == 32) { // Spacebar
-            if (!isRecording) {
-                audio.startRecording();
-                isRecording = true;
-            } else {
-                audio.stopRecording();
-                isRecording = false;
-            }
+            toggleRecording();
             // Small delay to avoid double-trigger
             cv::waitKey(200);
         }
@@ -287,9 +536,12 @@ int main() {
             cv::imwrite("agent_screenshot.jpg", frame);
             std::cout << "Screenshot saved!" << std::endl;
         }
+        if (key == 'o') saveYoloOutput();
     }
     
+    pipeline.stop();
+    detectionStream.close();
     audio.stopListening();
-    cv::destroyAllWindows();
+    if (!headless) cv::destroyAllWindows();
     return 0;
 }
\ No newline at end of file
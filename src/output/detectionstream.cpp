@@ -0,0 +1,375 @@
+#include "detectionstream.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Host order is the wire order: every target this builds for is little-endian
+template <typename T>
+uint8_t* put(uint8_t* out, T value) {
+    std::memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+int16_t clampToInt16(int value) {
+    return static_cast<int16_t>(std::min(32767, std::max(-32768, value)));
+}
+
+void closeFd(int& fd) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+}  // namespace
+
+DetectionStream::DetectionStream(const DetectionStreamConfig& config) : config_(config) {
+    config_.batchFrames = std::max<size_t>(1, config_.batchFrames);
+}
+
+DetectionStream::~DetectionStream() {
+    close();
+}
+
+bool DetectionStream::open(const std::string& spec) {
+    if (writer_.joinable()) {
+        std::cerr << "Detection stream already open: " << description_ << std::endl;
+        return false;
+    }
+    if (spec.rfind("unix:", 0) == 0) {
+        kind_ = Kind::Socket;
+        path_ = spec.substr(5);
+    } else if (spec.rfind("pipe:", 0) == 0) {
+        kind_ = Kind::Pipe;
+        path_ = spec.substr(5);
+    } else {
+        kind_ = Kind::File;
+        path_ = spec.rfind("file:", 0) == 0 ? spec.substr(5) : spec;
+    }
+    if (path_.empty()) {
+        std::cerr << "Detection stream needs a path: " << spec << std::endl;
+        return false;
+    }
+
+    // A reader that goes away must surface as EPIPE from write(), not kill the process
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (kind_ == Kind::File) {
+        fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) {
+            std::cerr << "Failed to open " << path_ << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        description_ = "file " + path_;
+    } else if (kind_ == Kind::Pipe) {
+        if (::mkfifo(path_.c_str(), 0644) != 0 && errno != EEXIST) {
+            std::cerr << "Failed to create pipe " << path_ << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        description_ = "pipe " + path_;
+    } else {
+        sockaddr_un address{};
+        if (path_.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << path_ << std::endl;
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ::unlink(path_.c_str());  // a stale socket from a previous run
+        if (listenFd_ < 0 || ::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd_, 1) != 0) {
+            std::cerr << "Failed to listen on " << path_ << ": " << std::strerror(errno) << std::endl;
+            closeFd(listenFd_);
+            return false;
+        }
+        description_ = "unix socket " + path_;
+    }
+
+    if (::pipe(wakeFds_) != 0) {
+        std::cerr << "Failed to create wake pipe: " << std::strerror(errno) << std::endl;
+        closeFd(fd_);
+        closeFd(listenFd_);
+        return false;
+    }
+    ::fcntl(wakeFds_[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(wakeFds_[1], F_SETFL, O_NONBLOCK);
+
+    clockOffset_ = std::chrono::system_clock::now().time_since_epoch() -
+                   std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                       std::chrono::steady_clock::now().time_since_epoch());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = DetectionStreamStats();
+        stats_.connected = fd_ >= 0;
+        pending_.clear();
+        pendingFrames_ = 0;
+    }
+    stopping_ = false;
+    writer_ = std::thread(&DetectionStream::writerLoop, this);
+    return true;
+}
+
+void DetectionStream::close() {
+    if (!writer_.joinable()) return;
+    stopping_ = true;
+    const char wake = 0;
+    (void)!::write(wakeFds_[1], &wake, 1);
+    writer_.join();
+
+    closeFd(fd_);
+    if (listenFd_ >= 0) {
+        closeFd(listenFd_);
+        ::unlink(path_.c_str());
+    }
+    closeFd(wakeFds_[0]);
+    closeFd(wakeFds_[1]);
+}
+
+void DetectionStream::publish(uint64_t sequence, std::chrono::steady_clock::time_point captured, bool inferred,
+                              const std::vector<Detection>& detections) {
+    const size_t count = std::min<size_t>(detections.size(), UINT16_MAX);
+    const size_t size = detstream::FRAME_HEADER_BYTES + count * detstream::DETECTION_BYTES;
+    const int64_t capturedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                   captured.time_since_epoch() + clockOffset_).count();
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Nobody to read it, or the writer is this far behind: the frame is stale anyway
+        if (!stats_.connected || pending_.size() + size > config_.maxPendingBytes) {
+            stats_.dropped++;
+            return;
+        }
+        if (pendingFrames_ == 0) oldestPending_ = std::chrono::steady_clock::now();
+
+        const size_t offset = pending_.size();
+        pending_.resize(offset + size);  // capacity settles after the first batches
+        uint8_t* out = pending_.data() + offset;
+        out = put<uint32_t>(out, static_cast<uint32_t>(size - sizeof(uint32_t)));
+        out = put<uint64_t>(out, sequence);
+        out = put<int64_t>(out, capturedUs);
+        out = put<uint8_t>(out, inferred ? detstream::FLAG_INFERRED : 0);
+        out = put<uint8_t>(out, 0);
+        out = put<uint16_t>(out, static_cast<uint16_t>(count));
+        for (size_t i = 0; i < count; i++) {
+            const Detection& det = detections[i];
+            out = put<int32_t>(out, det.trackId);
+            out = put<float>(out, det.score);
+            out = put<int16_t>(out, clampToInt16(det.box.x));
+            out = put<int16_t>(out, clampToInt16(det.box.y));
+            out = put<int16_t>(out, clampToInt16(det.box.width));
+            out = put<int16_t>(out, clampToInt16(det.box.height));
+            out = put<uint16_t>(out, static_cast<uint16_t>(det.classId));
+            out = put<uint16_t>(out, 0);
+        }
+        wake = ++pendingFrames_ == config_.batchFrames;
+    }
+    if (wake) {
+        const char byte = 0;
+        (void)!::write(wakeFds_[1], &byte, 1);  // a full wake pipe already means "wake up"
+    }
+}
+
+bool DetectionStream::nextCommand(StreamCommand& command) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (commands_.empty()) return false;
+    command = commands_.front();
+    commands_.pop_front();
+    return true;
+}
+
+DetectionStreamStats DetectionStream::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DetectionStream::writerLoop() {
+    uint8_t header[detstream::STREAM_HEADER_BYTES];
+    uint8_t* out = header;
+    for (char c : detstream::MAGIC) out = put<char>(out, c);
+    out = put<uint16_t>(out, detstream::VERSION);
+    put<uint16_t>(out, 0);
+    if (fd_ >= 0) send(header, sizeof(header));
+
+    while (true) {
+        int timeoutMs = static_cast<int>(config_.flushInterval.count());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pendingFrames_ > 0) {
+                auto due = oldestPending_ + config_.flushInterval - std::chrono::steady_clock::now();
+                timeoutMs = static_cast<int>(std::max<int64_t>(0,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(due).count()));
+            }
+        }
+        pollfd fds[2] = {{wakeFds_[0], POLLIN, 0}, {-1, 0, 0}};
+        if (kind_ == Kind::Socket) {
+            fds[1].fd = fd_ >= 0 ? fd_ : listenFd_;
+            fds[1].events = POLLIN;
+        } else if (kind_ == Kind::Pipe) {
+            fds[1].fd = fd_;
+        }
+        if (fd_ >= 0 && !unsent_.empty()) fds[1].events |= POLLOUT;
+        ::poll(fds, fds[1].fd >= 0 ? 2 : 1, timeoutMs);
+
+        char drain[64];
+        while (::read(wakeFds_[0], drain, sizeof(drain)) > 0) {}
+        if (kind_ == Kind::Pipe && fd_ >= 0 && (fds[1].revents & (POLLERR | POLLHUP))) {
+            dropSink();  // reader closed the pipe
+        } else if (fds[1].fd >= 0 && fds[1].fd == fd_ && (fds[1].revents & POLLOUT)) {
+            flushUnsent();
+        }
+        if (kind_ == Kind::Socket && fds[1].fd >= 0 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+            if (fd_ < 0) {
+                acceptClient();
+                if (fd_ >= 0) send(header, sizeof(header));
+            } else {
+                readCommands();
+            }
+        }
+        if (kind_ == Kind::Pipe && fd_ < 0 && openPipe()) send(header, sizeof(header));
+
+        const bool stopping = stopping_;
+        size_t frames = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pendingFrames_ > 0 &&
+                (stopping || pendingFrames_ >= config_.batchFrames ||
+                 std::chrono::steady_clock::now() - oldestPending_ >= config_.flushInterval)) {
+                std::swap(pending_, writing_);
+                frames = pendingFrames_;
+                pendingFrames_ = 0;
+            }
+        }
+        if (frames > 0) {
+            const bool written = fd_ >= 0 && send(writing_.data(), writing_.size());
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (written) {
+                stats_.frames += frames;
+                stats_.batches++;
+                stats_.bytes += writing_.size();
+            } else {
+                stats_.dropped += frames;
+            }
+            writing_.clear();
+        }
+        if (stopping) {
+            // One last chance for a partial write, bounded like any flush
+            if (fd_ >= 0 && !unsent_.empty()) {
+                pollfd out = {fd_, POLLOUT, 0};
+                if (::poll(&out, 1, static_cast<int>(config_.flushInterval.count())) > 0) flushUnsent();
+            }
+            break;
+        }
+    }
+}
+
+bool DetectionStream::openPipe() {
+    // Non-blocking open fails with ENXIO until a reader has the pipe open;
+    // the descriptor stays non-blocking for send()
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_NONBLOCK);
+    if (fd_ < 0) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.connected = true;
+    return true;
+}
+
+void DetectionStream::acceptClient() {
+    fd_ = ::accept(listenFd_, nullptr, nullptr);
+    if (fd_ < 0) return;
+    // Non-blocking like a pipe: a client that stops reading costs frames
+    ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+    commandBuffer_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.connected = true;
+}
+
+void DetectionStream::readCommands() {
+    char buffer[256];
+    ssize_t received = ::recv(fd_, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+        if (received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        dropSink();  // client closed the connection
+        return;
+    }
+    commandBuffer_.append(buffer, static_cast<size_t>(received));
+
+    size_t start = 0, end;
+    while ((end = commandBuffer_.find('\n', start)) != std::string::npos) {
+        std::string line = commandBuffer_.substr(start, end - start);
+        start = end + 1;
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        line.erase(0, line.find_first_not_of(" \t"));
+        if (line.empty()) continue;
+
+        StreamCommand command;
+        if (line == "record") command = StreamCommand::StartRecording;
+        else if (line == "stop") command = StreamCommand::StopRecording;
+        else if (line == "dump") command = StreamCommand::SaveOutput;
+        else if (line == "quit") command = StreamCommand::Quit;
+        else {
+            std::cerr << "Unknown stream command: " << line << std::endl;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back(command);
+    }
+    commandBuffer_.erase(0, start);
+    if (commandBuffer_.size() > 1024) commandBuffer_.clear();  // not a command stream
+}
+
+void DetectionStream::dropSink() {
+    closeFd(fd_);
+    unsent_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.connected = false;
+}
+
+// Writes what the sink takes now and keeps the rest in unsent_. False if
+// nothing of data was sent: the sink is gone, or an earlier partial write
+// is still outstanding and data would tear it.
+bool DetectionStream::send(const uint8_t* data, size_t size) {
+    if (!flushUnsent() || !unsent_.empty()) return false;
+    while (size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                unsent_.assign(data, data + size);  // POLLOUT in writerLoop sends it
+                return true;
+            }
+            // Reader gone: pipes and sockets wait for the next one
+            if (kind_ == Kind::File) std::cerr << "Detection stream write failed: " << std::strerror(errno) << std::endl;
+            dropSink();
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// False if the sink failed; unsent_ may still hold bytes the sink is not ready for
+bool DetectionStream::flushUnsent() {
+    size_t sent = 0;
+    while (sent < unsent_.size()) {
+        ssize_t written = ::write(fd_, unsent_.data() + sent, unsent_.size() - sent);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            dropSink();
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    unsent_.erase(unsent_.begin(), unsent_.begin() + static_cast<std::ptrdiff_t>(sent));
+    return true;
+}
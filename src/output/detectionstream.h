@@ -0,0 +1,124 @@
+#pragma once
+#include "../vision/visionmodule.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Wire format, little-endian. Every sink starts with the 8-byte stream
+// header, then one length-prefixed message per frame:
+//
+//   stream header   char magic[4] = "DETS", uint16 version = 1, uint16 reserved
+//   frame message   uint32 length (bytes after this field)
+//                   uint64 sequence, int64 captured (us since the Unix epoch)
+//                   uint8 flags (bit 0: the detector ran), uint8 reserved,
+//                   uint16 count, then count detection records
+//   detection       int32 trackId (-1: untracked), float32 score,
+//                   int16 x, y, width, height (full-frame pixels),
+//                   uint16 classId, uint16 reserved
+//
+// Readers skip unknown trailing bytes using length, so fields can be added.
+namespace detstream {
+static constexpr char MAGIC[4] = {'D', 'E', 'T', 'S'};
+static constexpr uint16_t VERSION = 1;
+static constexpr size_t STREAM_HEADER_BYTES = 8;
+static constexpr size_t FRAME_HEADER_BYTES = 24;  // length prefix included
+static constexpr size_t DETECTION_BYTES = 20;
+static constexpr uint8_t FLAG_INFERRED = 1;
+}  // namespace detstream
+
+// Text commands read from a unix-socket client, one per line
+enum class StreamCommand {
+    StartRecording,  // "record": start capturing a voice command
+    StopRecording,   // "stop": stop and transcribe
+    SaveOutput,      // "dump": write the raw YOLO output to yolo_output.bin
+    Quit,            // "quit"
+};
+
+struct DetectionStreamConfig {
+    size_t batchFrames = 8;                           // write once this many frames are queued...
+    std::chrono::milliseconds flushInterval{50};      // ...or once the oldest has waited this long
+    size_t maxPendingBytes = 1 << 20;                 // frames beyond this are dropped, not queued
+};
+
+struct DetectionStreamStats {
+    uint64_t frames = 0;    // frames written
+    uint64_t batches = 0;   // write calls
+    uint64_t bytes = 0;
+    uint64_t dropped = 0;   // writer behind, or nobody reading
+    bool connected = false; // a reader is attached
+};
+
+// Per-frame detections streamed to a file, a named pipe or a unix socket.
+//
+// publish() only encodes into a pending buffer; a writer thread batches the
+// buffer out, so a slow or absent reader costs dropped frames, never a stall
+// in the caller. Pipes and sockets are written non-blocking: the rest of a
+// partial write goes out first once the reader catches up, and batches that
+// arrive meanwhile are dropped, so a stuck reader neither stalls the writer
+// (or close()) nor receives a torn record. Named pipes are opened by the
+// writer thread, so startup does not wait for a reader, and reopened when
+// the reader goes away. A unix socket is listened on by the agent; one
+// client at a time receives the stream and may send commands back
+// (nextCommand()).
+class DetectionStream {
+public:
+    explicit DetectionStream(const DetectionStreamConfig& config = DetectionStreamConfig());
+    ~DetectionStream();
+    DetectionStream(const DetectionStream&) = delete;
+    DetectionStream& operator=(const DetectionStream&) = delete;
+
+    // spec: file:<path> (or a bare path), pipe:<path> (a FIFO, created if
+    // missing) or unix:<path>. Starts the writer thread.
+    bool open(const std::string& spec);
+    // Flushes what is pending and stops the writer thread
+    void close();
+
+    void publish(uint64_t sequence, std::chrono::steady_clock::time_point captured, bool inferred,
+                 const std::vector<Detection>& detections);
+
+    // Next command received from the socket client; false if none is waiting
+    bool nextCommand(StreamCommand& command);
+
+    DetectionStreamStats stats() const;
+    const std::string& describe() const { return description_; }
+
+private:
+    enum class Kind { File, Pipe, Socket };
+
+    void writerLoop();
+    bool openPipe();
+    void acceptClient();
+    void readCommands();
+    void dropSink();
+    bool send(const uint8_t* data, size_t size);
+    bool flushUnsent();
+
+    DetectionStreamConfig config_;
+    Kind kind_ = Kind::File;
+    std::string path_;
+    std::string description_;
+    int fd_ = -1;        // file, pipe or connected client
+    int listenFd_ = -1;  // socket only
+    int wakeFds_[2] = {-1, -1};
+    std::thread writer_;
+    std::atomic<bool> stopping_{false};
+
+    // Capture times are steady_clock; the stream carries wall-clock time
+    std::chrono::system_clock::duration clockOffset_{};
+
+    mutable std::mutex mutex_;
+    std::vector<uint8_t> pending_;  // encoded frames not yet written
+    size_t pendingFrames_ = 0;
+    std::chrono::steady_clock::time_point oldestPending_;
+    DetectionStreamStats stats_;
+    std::deque<StreamCommand> commands_;
+
+    std::vector<uint8_t> writing_;  // writer thread only
+    std::vector<uint8_t> unsent_;   // writer thread only: tail of a partial write
+    std::string commandBuffer_;     // writer thread only
+};
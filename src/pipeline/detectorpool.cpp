@@ -0,0 +1,132 @@
+#include "detectorpool.h"
+#include <iostream>
+
+DetectorPool::DetectorPool(const std::string& modelPath) : modelPath_(modelPath) {}
+
+DetectorPool::~DetectorPool() {
+    stop();
+}
+
+bool DetectorPool::init(VisionModule& primary, size_t sessions,
+                        const std::function<bool(VisionModule&)>& configure) {
+    modules_ = {&primary};
+    for (size_t i = 1; i < sessions; i++) {
+        auto vision = std::make_unique<VisionModule>(modelPath_);
+        if (!configure(*vision)) {
+            std::cerr << "Failed to configure detector session " << i << std::endl;
+            return false;
+        }
+        vision->setPrepackedWeights(&prepackedWeights_);
+        if (!vision->init()) {
+            std::cerr << "Failed to initialize detector session " << i << std::endl;
+            return false;
+        }
+        modules_.push_back(vision.get());
+        ownedModules_.push_back(std::move(vision));
+    }
+    std::cout << "Detector pool: " << modules_.size() << " sessions" << std::endl;
+    return true;
+}
+
+void DetectorPool::start(bool tiled) {
+    tiled_ = tiled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    for (VisionModule* vision : modules_) {
+        workers_.emplace_back(&DetectorPool::workerLoop, this, std::ref(*vision));
+    }
+}
+
+void DetectorPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workReady_.notify_all();
+    frameReady_.notify_all();
+    spaceFree_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+}
+
+bool DetectorPool::submit(FramePacket packet) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    spaceFree_.wait(lock, [&] { return stopping_ || inFlight_ < 2 * modules_.size(); });
+    if (stopping_) return false;
+
+    uint64_t index = nextIndex_++;
+    inFlight_++;
+    if (packet.inferred) {
+        jobs_.push_back({index, std::move(packet)});
+        lock.unlock();
+        workReady_.notify_one();
+    } else {
+        done_.emplace(index, std::move(packet));
+        lock.unlock();
+        frameReady_.notify_all();
+    }
+    return true;
+}
+
+void DetectorPool::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    frameReady_.notify_all();
+}
+
+bool DetectorPool::next(FramePacket& packet, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    frameReady_.wait_for(lock, timeout, [&] {
+        return stopping_ || (closed_ && inFlight_ == 0) || done_.count(nextOut_) > 0;
+    });
+    auto it = done_.find(nextOut_);
+    if (stopping_ || it == done_.end()) return false;
+
+    packet = std::move(it->second);
+    done_.erase(it);
+    nextOut_++;
+    inFlight_--;
+    lock.unlock();
+    spaceFree_.notify_one();
+    return true;
+}
+
+bool DetectorPool::drained() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stopping_ || (closed_ && inFlight_ == 0);
+}
+
+size_t DetectorPool::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inFlight_;
+}
+
+void DetectorPool::workerLoop(VisionModule& vision) {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workReady_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        if (!job.packet.outputDump.empty()) vision.dumpNextOutput(job.packet.outputDump);
+        if (tiled_) vision.detectTiled(job.packet.detectorInput(), job.packet.detections);
+        else vision.detect(job.packet.detectorInput(), job.packet.detections);
+        job.packet.scaleDetectionsToFrame();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.emplace(job.index, std::move(job.packet));
+        }
+        frameReady_.notify_all();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "framepacket.h"
+#include "../vision/visionmodule.h"
+#include <onnxruntime/onnxruntime_cxx_api.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frame-parallel detection: N sessions of the same model each take the next
+// frame as soon as they are free, so consecutive frames are inferred
+// concurrently. Sessions share one PrepackedWeightsContainer, so the
+// pre-packed GEMM/conv weights exist once instead of N times.
+//
+// Frames leave the pool in submission order: finished frames wait in a
+// reorder buffer until every earlier frame has come out, so the tracker
+// never sees time run backwards. At most 2*N frames are in flight.
+class DetectorPool {
+public:
+    explicit DetectorPool(const std::string& modelPath);
+    ~DetectorPool();
+
+    DetectorPool(const DetectorPool&) = delete;
+    DetectorPool& operator=(const DetectorPool&) = delete;
+
+    // Hand to the primary VisionModule before its init() so it shares weights with the pool
+    Ort::PrepackedWeightsContainer* prepackedWeights() { return &prepackedWeights_; }
+
+    // primary (already initialised, not owned) becomes session 0; sessions - 1
+    // more are created, passed to configure and initialised. False if
+    // configure or an init() fails.
+    bool init(VisionModule& primary, size_t sessions, const std::function<bool(VisionModule&)>& configure);
+    size_t sessions() const { return modules_.size(); }
+
+    // Worker threads; tiled selects detectTiled() over detect()
+    void start(bool tiled);
+    // Wakes every waiter and joins the workers; queued frames are dropped
+    void stop();
+
+    // Producer: waits for room, then queues the frame (packets with
+    // inferred == false pass straight to the reorder buffer). False once stopped.
+    bool submit(FramePacket packet);
+    // Producer is done; drained() turns true after the last frame is taken
+    void close();
+
+    // Consumer: next frame in submission order, or false on timeout
+    bool next(FramePacket& packet, std::chrono::milliseconds timeout);
+    bool drained() const;
+    size_t inFlight() const;
+
+private:
+    struct Job {
+        uint64_t index;
+        FramePacket packet;
+    };
+    void workerLoop(VisionModule& vision);
+
+    std::string modelPath_;
+    Ort::PrepackedWeightsContainer prepackedWeights_;
+    std::vector<VisionModule*> modules_;
+    std::vector<std::unique_ptr<VisionModule>> ownedModules_;
+    std::vector<std::thread> workers_;
+    bool tiled_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workReady_;   // jobs_ non-empty
+    std::condition_variable frameReady_;  // done_ gained the next index
+    std::condition_variable spaceFree_;   // inFlight_ dropped
+    std::deque<Job> jobs_;
+    std::map<uint64_t, FramePacket> done_;  // reorder buffer
+    uint64_t nextIndex_ = 0;   // given to the next submitted frame
+    uint64_t nextOut_ = 0;     // index next() hands out
+    size_t inFlight_ = 0;      // submitted but not yet taken by next()
+    bool closed_ = false;
+    bool stopping_ = false;
+};
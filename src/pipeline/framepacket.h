@@ -0,0 +1,69 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../vision/visionmodule.h"
+#include "../vision/roischeduler.h"
+#include "../capture/framepool.h"
+#include "../capture/jpegdecoder.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A frame moving through the pipeline together with everything computed for it.
+//
+// With reduced-scale decoding the pooled buffer holds a 1/2 or 1/4 scale
+// decode (detectFrame) and frame stays empty until decodeFullFrame() decodes
+// the kept JPEG bytes at full resolution for display.
+struct FramePacket {
+    FrameBuffer buffer;                 // pooled pixels; frame (or detectFrame) is a header onto them
+    cv::Mat frame;
+    FrameBuffer encoded;                // JPEG bytes, reduced-scale decoding only
+    size_t encodedSize = 0;
+    cv::Mat detectFrame;                // reduced-scale decode for the detector
+    cv::Size frameSize;                 // full-resolution size
+    uint64_t sequence = 0;              // successful reads in capture order; downstream gaps are queue drops
+    std::chrono::steady_clock::time_point captured;
+    std::vector<Detection> detections;  // raw detector output (detect stage)
+    std::vector<Detection> tracked;     // smoothed tracker output (track stage)
+    bool inferred = true;               // false: motion gate skipped the detector
+    InferenceMode mode = InferenceMode::Keyframe;
+    std::string outputDump;             // non-empty: the detector writes its raw output here
+
+    // The image the motion gate and detector look at
+    const cv::Mat& detectorInput() const { return detectFrame.empty() ? frame : detectFrame; }
+
+    // Maps detections made on detectFrame to full-resolution coordinates
+    void scaleDetectionsToFrame() {
+        if (detectFrame.empty() || detectFrame.size() == frameSize) return;
+        const float scaleX = static_cast<float>(frameSize.width) / static_cast<float>(detectFrame.cols);
+        const float scaleY = static_cast<float>(frameSize.height) / static_cast<float>(detectFrame.rows);
+        for (Detection& det : detections) {
+            det.box = cv::Rect(cvRound(det.box.x * scaleX), cvRound(det.box.y * scaleY),
+                               cvRound(det.box.width * scaleX), cvRound(det.box.height * scaleY)) &
+                      cv::Rect(0, 0, frameSize.width, frameSize.height);
+        }
+    }
+
+    // Full-resolution frame for display: decoded into scratch on first use
+    // when only the reduced decode exists. False if it cannot be decoded.
+    bool decodeFullFrame(cv::Mat& scratch) {
+        if (!frame.empty()) return true;
+        if (!encoded || !JpegDecoder::decode(encoded->ptr(), encodedSize, 1, scratch)) return false;
+        frame = scratch;
+        return true;
+    }
+};
+
+// Track-stage output without the frame, published for a render loop that
+// draws every captured frame (VisionPipeline::setDisplayTap)
+struct TrackSnapshot {
+    static constexpr uint64_t NONE = ~0ull;
+
+    uint64_t sequence = NONE;           // capture sequence of the tracked frame
+    std::chrono::steady_clock::time_point captured;
+    std::vector<Detection> tracks;
+    bool inferred = true;
+    InferenceMode mode = InferenceMode::Keyframe;
+
+    bool published() const { return sequence != NONE; }
+};
@@ -0,0 +1,268 @@
+#include "pipeline.h"
+#include <iostream>
+
+static constexpr std::chrono::milliseconds STAGE_POLL_TIMEOUT(100);
+// Corrupt JPEG frames are reported on the first and then every Nth skip
+static constexpr uint64_t UNDECODABLE_REPORT_INTERVAL = 100;
+
+VisionPipeline::VisionPipeline(FrameSource& source, FramePool& pool, VisionModule& vision, SimpleTracker& tracker)
+    : source_(source), framePool_(pool), vision_(vision), tracker_(tracker),
+      captureQueue_(QUEUE_CAPACITY), detectQueue_(QUEUE_CAPACITY), renderQueue_(QUEUE_CAPACITY),
+      displayQueue_(QUEUE_CAPACITY) {}
+
+VisionPipeline::~VisionPipeline() {
+    stop();
+}
+
+void VisionPipeline::start() {
+    shouldStop_ = false;
+    if (detectorPool_) detectorPool_->start(tiled_);
+    captureThread_ = std::thread(&VisionPipeline::captureLoop, this);
+    detectThread_ = std::thread(&VisionPipeline::detectLoop, this);
+    trackThread_ = std::thread(&VisionPipeline::trackLoop, this);
+}
+
+void VisionPipeline::stop() {
+    shouldStop_ = true;
+    if (detectorPool_) detectorPool_->stop();
+    if (captureThread_.joinable()) captureThread_.join();
+    if (detectThread_.joinable()) detectThread_.join();
+    if (trackThread_.joinable()) trackThread_.join();
+}
+
+bool VisionPipeline::nextFrame(FramePacket& packet, std::chrono::milliseconds timeout) {
+    return renderQueue_.pop(packet, timeout);
+}
+
+bool VisionPipeline::nextDisplayFrame(FramePacket& packet, std::chrono::milliseconds timeout) {
+    return displayQueue_.pop(packet, timeout);
+}
+
+bool VisionPipeline::latestTracks(TrackSnapshot& snapshot) const {
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    if (!snapshot_.published() || snapshot_.sequence == snapshot.sequence) return false;
+    snapshot = snapshot_;
+    return true;
+}
+
+std::array<QueueStats, 4> VisionPipeline::stats() const {
+    return {{
+        {"capture", captureQueue_.depth(), captureQueue_.pushes(), captureQueue_.drops()},
+        {"detect", detectQueue_.depth(), detectQueue_.pushes(), detectQueue_.drops()},
+        {"track", renderQueue_.depth(), renderQueue_.pushes(), renderQueue_.drops()},
+        {"display", displayQueue_.depth(), displayQueue_.pushes(), displayQueue_.drops()},
+    }};
+}
+
+void VisionPipeline::requestOutputDump(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        dumpPath_ = path;
+    }
+    dumpRequested_ = true;
+}
+
+MotionGateStats VisionPipeline::motionGateStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return gateStats_;
+}
+
+RoiSchedulerStats VisionPipeline::roiSchedulerStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return roiStats_;
+}
+
+FlowStats VisionPipeline::flowStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return flowStats_;
+}
+
+ResolutionControllerStats VisionPipeline::resolutionStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return resolutionStats_;
+}
+
+void VisionPipeline::captureLoop() {
+    uint64_t sequence = 0;
+    while (!shouldStop_) {
+        FramePacket packet;
+        // Every buffer is still in use downstream: wait for the render stage to release one
+        packet.buffer = framePool_.acquire(STAGE_POLL_TIMEOUT);
+        if (!packet.buffer) continue;
+
+        if (!captureFrame(packet)) {
+            if (!shouldStop_) std::cerr << "Capture source ended: " << source_.describe() << std::endl;
+            break;
+        }
+        packet.sequence = sequence++;
+        packet.captured = std::chrono::steady_clock::now();
+        if (displayTap_) displayQueue_.push(packet);  // shares the pooled buffer: read-only for the renderer
+        captureQueue_.push(std::move(packet));
+    }
+    captureQueue_.close();
+    displayQueue_.close();
+}
+
+// Reads the next frame into packet.buffer: decoded in full, or (reduced
+// decoding) as JPEG bytes plus a DCT-scaled decode for the detector
+bool VisionPipeline::captureFrame(FramePacket& packet) {
+    if (reducedScale_ <= 1 || !encodedPool_) {
+        const uchar* previousData = packet.buffer->data;
+        if (!source_.read(*packet.buffer)) return false;
+        framePool_.noteWrite(packet.buffer, previousData);
+        packet.frame = *packet.buffer;  // header only, shares the pooled pixels
+        packet.frameSize = packet.frame.size();
+        return true;
+    }
+
+    while (!shouldStop_) {
+        packet.encoded = encodedPool_->acquire(STAGE_POLL_TIMEOUT);
+        if (packet.encoded) break;
+    }
+    if (!packet.encoded) return false;
+    while (!shouldStop_) {
+        const uchar* previousData = packet.encoded->data;
+        if (!source_.readEncoded(*packet.encoded, packet.encodedSize)) return false;
+        encodedPool_->noteWrite(packet.encoded, previousData);
+
+        previousData = packet.buffer->data;
+        if (JpegDecoder::readSize(packet.encoded->ptr(), packet.encodedSize, packet.frameSize) &&
+            JpegDecoder::decode(packet.encoded->ptr(), packet.encodedSize, reducedScale_, *packet.buffer)) {
+            framePool_.noteWrite(packet.buffer, previousData);
+            packet.detectFrame = *packet.buffer;
+            return true;
+        }
+        if (undecodableFrames_++ % UNDECODABLE_REPORT_INTERVAL == 0) {
+            std::cerr << "Skipping undecodable JPEG frames (" << undecodableFrames_ << " so far)" << std::endl;
+        }
+    }
+    return false;
+}
+
+void VisionPipeline::detectLoop() {
+    FramePacket packet;
+    while (!shouldStop_) {
+        if (!captureQueue_.pop(packet, STAGE_POLL_TIMEOUT)) {
+            if (captureQueue_.closed()) break;
+            continue;
+        }
+        // Off-interval frames are skipped without consulting the motion gate
+        bool due = ++framesSinceDetect_ >= detectInterval_;
+        packet.inferred = due && (!motionGate_ || motionGate_->shouldInfer(packet.detectorInput(), packet.captured));
+        if (packet.inferred) framesSinceDetect_ = 0;
+        if (!packet.inferred) packet.detections.clear();
+        if (packet.inferred && dumpRequested_.exchange(false)) {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            packet.outputDump = dumpPath_;
+        }
+        if (detectorPool_) {
+            // Waits for a free session; the pool restores frame order for the track stage
+            bool submitted = detectorPool_->submit(std::move(packet));
+            packet = FramePacket();
+            if (motionGate_) {
+                std::lock_guard<std::mutex> lock(statsMutex_);
+                gateStats_ = motionGate_->stats();
+            }
+            if (!submitted) break;
+            continue;
+        }
+        if (packet.inferred) runDetector(packet);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            if (motionGate_) gateStats_ = motionGate_->stats();
+            if (roiScheduler_) roiStats_ = roiScheduler_->stats();
+            if (resolutionController_) resolutionStats_ = resolutionController_->stats();
+        }
+        detectQueue_.push(std::move(packet));
+    }
+    if (detectorPool_) detectorPool_->close();
+    detectQueue_.close();
+}
+
+// Full frame, or only the regions around the latest tracks if the scheduler says so
+void VisionPipeline::runDetector(FramePacket& packet) {
+    static constexpr int KEYFRAME_INPUT_SIZE = 640;
+    packet.mode = InferenceMode::Keyframe;
+    if (!packet.outputDump.empty()) vision_.dumpNextOutput(packet.outputDump);
+    if (!roiScheduler_) {
+        detectFullFrame(packet);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(trackBoxesMutex_);
+        detectTrackBoxes_ = trackBoxes_;
+    }
+    if (roiScheduler_->decide(detectTrackBoxes_, packet.frame.size(), roiRegions_) == InferenceMode::Roi) {
+        int inputSize = vision_.detectRegions(packet.frame, roiRegions_, packet.detections);
+        if (inputSize > 0) {
+            roiScheduler_->reportRoiFrame(inputSize);
+            packet.mode = InferenceMode::Roi;
+            return;
+        }
+        detectFullFrame(packet);
+        roiScheduler_->reportFallback(KEYFRAME_INPUT_SIZE);
+        return;
+    }
+    detectFullFrame(packet);
+    roiScheduler_->reportKeyframe(KEYFRAME_INPUT_SIZE);
+}
+
+void VisionPipeline::detectFullFrame(FramePacket& packet) {
+    if (tiled_) {
+        vision_.detectTiled(packet.detectorInput(), packet.detections);
+        packet.scaleDetectionsToFrame();
+        return;
+    }
+    if (resolutionController_) vision_.setInputSize(resolutionController_->inputSize());
+    vision_.detect(packet.detectorInput(), packet.detections);
+    packet.scaleDetectionsToFrame();
+    if (resolutionController_) resolutionController_->update(vision_.lastRunMs());
+}
+
+void VisionPipeline::trackLoop() {
+    FramePacket packet;
+    while (!shouldStop_) {
+        if (detectorPool_) {
+            if (!detectorPool_->next(packet, STAGE_POLL_TIMEOUT)) {
+                if (detectorPool_->drained()) break;
+                continue;
+            }
+        } else if (!detectQueue_.pop(packet, STAGE_POLL_TIMEOUT)) {
+            if (detectQueue_.closed()) break;
+            continue;
+        }
+        // Detector skipped the frame: coast the tracks on their motion model
+        // without counting it as a miss
+        if (packet.inferred) {
+            tracker_.updateTracks(packet.detections, lastTracked_);
+            if (flow_) flow_->seed(packet.detectorInput(), packet.frameSize, packet.detections, lastTracked_);
+        } else {
+            // The filters still advance a step; flow boxes replace their
+            // prediction when the propagator is on
+            tracker_.predictTracks(lastTracked_);
+            if (flow_) flow_->propagate(packet.detectorInput(), packet.frameSize, lastTracked_);
+        }
+        if (flow_) {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            flowStats_ = flow_->stats();
+        }
+        if (roiScheduler_) {
+            tracker_.trackBoxes(trackBoxesScratch_);
+            std::lock_guard<std::mutex> lock(trackBoxesMutex_);
+            trackBoxes_.swap(trackBoxesScratch_);
+        }
+        if (displayTap_) {
+            std::lock_guard<std::mutex> lock(snapshotMutex_);
+            snapshot_.sequence = packet.sequence;
+            snapshot_.captured = packet.captured;
+            snapshot_.tracks = lastTracked_;
+            snapshot_.inferred = packet.inferred;
+            snapshot_.mode = packet.mode;
+            continue;
+        }
+        packet.tracked = lastTracked_;
+        renderQueue_.push(std::move(packet));
+    }
+    renderQueue_.close();
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "spscqueue.h"
+#include "framepacket.h"
+#include "detectorpool.h"
+#include "../capture/framesource.h"
+#include "../capture/framepool.h"
+#include "../vision/visionmodule.h"
+#include "../vision/motiongate.h"
+#include "../vision/roischeduler.h"
+#include "../vision/resolutioncontroller.h"
+#include "../tracking/tracker.h"
+#include "../tracking/flowpropagator.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct QueueStats {
+    const char* name;
+    size_t depth;
+    uint64_t pushes;
+    uint64_t drops;
+};
+
+// Staged capture → detect → track → render pipeline.
+//
+// Capture, detection and tracking each run on their own thread, connected by
+// bounded drop-oldest SPSC queues: a slow stage never backs up the one before
+// it, it just skips to the freshest frame. Rendering is pulled by the caller
+// with nextFrame(), so HighGUI calls stay on the main thread (required on macOS).
+//
+// Frames are read straight into buffers from a FramePool and only Mat headers
+// travel with the packets; a dropped or rendered packet returns its buffer.
+class VisionPipeline {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 2;
+    // Buffers the pipeline can hold at once without a pooled detector: every
+    // queue (display tap included) full plus one packet in each stage and one
+    // being rendered
+    static constexpr size_t FRAMES_IN_FLIGHT = 4 * QUEUE_CAPACITY + 4;
+
+    VisionPipeline(FrameSource& source, FramePool& pool, VisionModule& vision, SimpleTracker& tracker);
+    ~VisionPipeline();
+
+    void start();
+    void stop();
+    // False once the capture source has ended and every queue is drained
+    bool running() const {
+        const SpscQueue<FramePacket>& last = displayTap_ ? displayQueue_ : renderQueue_;
+        return !last.closed() || last.depth() > 0;
+    }
+
+    // Render stage: next fully processed frame, or false on timeout/end of stream
+    bool nextFrame(FramePacket& packet, std::chrono::milliseconds timeout);
+
+    // Display tap (set before start()): every captured frame also goes
+    // straight to the render loop through nextDisplayFrame(), to be drawn
+    // with the latest tracks from latestTracks(). Its pixels are shared with
+    // the detect and track stages, so the renderer must draw on a copy. The
+    // track stage then only
+    // publishes snapshots and nextFrame() stays empty, so rendering runs at
+    // the capture rate whatever the detector rate.
+    void setDisplayTap(bool enabled) { displayTap_ = enabled; }
+    bool nextDisplayFrame(FramePacket& packet, std::chrono::milliseconds timeout);
+    // Copies the latest track snapshot into snapshot if it is newer than the
+    // one snapshot holds
+    bool latestTracks(TrackSnapshot& snapshot) const;
+
+    // Depth, push and drop counters for the capture, detect, track and
+    // display-tap queues
+    std::array<QueueStats, 4> stats() const;
+
+    // Optional motion gate in front of the detector (not owned; set before
+    // start()). Frames it rejects reuse the previous tracker output.
+    void setMotionGate(MotionGate* gate) { motionGate_ = gate; }
+    MotionGateStats motionGateStats() const;
+
+    // Optional keyframe/ROI scheduler (not owned; set before start()). Between
+    // keyframes the detector only sees regions around the current tracks.
+    void setRoiScheduler(RoiScheduler* scheduler) { roiScheduler_ = scheduler; }
+    RoiSchedulerStats roiSchedulerStats() const;
+
+    // Run the detector on every Nth frame only (set before start()); the
+    // frames in between reuse the tracks, moved by the flow propagator if set
+    void setDetectInterval(int frames) { detectInterval_ = std::max(1, frames); }
+
+    // Optional optical-flow stage moving track boxes on frames without
+    // detections (not owned; set before start())
+    void setFlowPropagator(FlowPropagator* flow) { flow_ = flow; }
+    FlowStats flowStats() const;
+
+    // Full-frame passes use VisionModule::detectTiled (set before start())
+    void setTiledInference(bool tiled) { tiled_ = tiled; }
+
+    // Optional latency-budget controller choosing the full-frame input size
+    // (not owned; set before start(); needs a dynamic-size model)
+    void setResolutionController(ResolutionController* controller) { resolutionController_ = controller; }
+    ResolutionControllerStats resolutionStats() const;
+
+    // Decode JPEG frames at 1/scaleDenom (2 or 4) for the detector instead of
+    // at full resolution; encodedPool holds the JPEG bytes until rendering.
+    // Needs a source with supportsEncoded(); set before start(). Not combined
+    // with ROI inference, whose regions are in full-resolution coordinates.
+    void setReducedDecode(int scaleDenom, FramePool* encodedPool) {
+        reducedScale_ = scaleDenom;
+        encodedPool_ = encodedPool;
+    }
+
+    // Optional pool of sessions running consecutive frames concurrently (not
+    // owned; set before start()). Replaces the single-session detector, so the
+    // ROI scheduler and resolution controller are not used with it.
+    void setDetectorPool(DetectorPool* pool) { detectorPool_ = pool; }
+
+    // The detect stage writes the raw output tensor of the next inferred
+    // frame to path, on whichever session runs it (VisionModule::dumpNextOutput)
+    void requestOutputDump(const std::string& path);
+
+private:
+    void captureLoop();
+    bool captureFrame(FramePacket& packet);
+    void detectLoop();
+    void trackLoop();
+    void runDetector(FramePacket& packet);
+    void detectFullFrame(FramePacket& packet);
+
+    FrameSource& source_;
+    FramePool& framePool_;
+    VisionModule& vision_;
+    SimpleTracker& tracker_;
+
+    SpscQueue<FramePacket> captureQueue_;  // capture → detect
+    SpscQueue<FramePacket> detectQueue_;   // detect → track
+    SpscQueue<FramePacket> renderQueue_;   // track → render
+    SpscQueue<FramePacket> displayQueue_;  // capture → render (display tap)
+    bool displayTap_ = false;
+    mutable std::mutex snapshotMutex_;
+    TrackSnapshot snapshot_;               // published by the track stage
+
+    MotionGate* motionGate_ = nullptr;
+    int detectInterval_ = 1;
+    int framesSinceDetect_ = 0;  // detect stage only
+    FlowPropagator* flow_ = nullptr;
+    FlowStats flowStats_;        // guarded by statsMutex_
+    mutable std::mutex statsMutex_;
+    MotionGateStats gateStats_;
+    std::vector<Detection> lastTracked_;  // track stage only
+
+    bool tiled_ = false;
+    int reducedScale_ = 1;
+    FramePool* encodedPool_ = nullptr;
+    uint64_t undecodableFrames_ = 0;  // capture stage only
+    DetectorPool* detectorPool_ = nullptr;
+    ResolutionController* resolutionController_ = nullptr;
+    ResolutionControllerStats resolutionStats_;  // guarded by statsMutex_
+    RoiScheduler* roiScheduler_ = nullptr;
+    RoiSchedulerStats roiStats_;             // guarded by statsMutex_
+    mutable std::mutex trackBoxesMutex_;
+    std::vector<cv::Rect> trackBoxes_;       // published by the track stage
+    std::vector<cv::Rect> trackBoxesScratch_; // track stage only
+    std::vector<cv::Rect> detectTrackBoxes_;  // detect stage only
+    std::vector<cv::Rect> roiRegions_;        // detect stage only
+    std::atomic<bool> dumpRequested_{false};
+    std::string dumpPath_;                    // guarded by statsMutex_
+
+    std::atomic<bool> shouldStop_{false};
+    std::thread captureThread_;
+    std::thread detectThread_;
+    std::thread trackThread_;
+};
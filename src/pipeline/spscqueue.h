@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bounded single-producer/single-consumer ring with drop-oldest semantics.
+//
+// push() never blocks on the consumer: when the ring is full the oldest item
+// is discarded, so the consumer always sees the freshest data. Both sides
+// advance the read index with a CAS (the consumer to pop, the producer to
+// drop). The consumer reads an item before claiming it and announces the
+// index it is reading; the producer only waits for that announcement to clear
+// when it is about to overwrite the very slot being moved out, which costs
+// at most one move of T.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : capacity_(capacity), slots_(capacity + 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false if the oldest item had to be dropped.
+    bool push(T item) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load();
+        bool dropped = false;
+        if (head - tail >= capacity_) {
+            // Full: drop the oldest. If the CAS fails the consumer just popped it.
+            if (tail_.compare_exchange_strong(tail, tail + 1)) {
+                dropped = true;
+                drops_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // The slot for head last held index head - slots; wait out a consumer
+        // that is still moving from it
+        const uint64_t previous = head - slots_.size();
+        while (head >= slots_.size() && reading_.load() == previous) {
+            std::this_thread::yield();
+        }
+
+        slots_[head % slots_.size()] = std::move(item);
+        head_.store(head + 1, std::memory_order_release);
+        pushes_.fetch_add(1, std::memory_order_relaxed);
+        return !dropped;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool tryPop(T& out) {
+        while (true) {
+            uint64_t tail = tail_.load();
+            if (tail == head_.load(std::memory_order_acquire)) return false;
+
+            reading_.store(tail);
+            if (tail_.load() != tail) continue;  // dropped before we announced
+
+            out = std::move(slots_[tail % slots_.size()]);
+            bool claimed = tail_.compare_exchange_strong(tail, tail + 1);
+            reading_.store(NOT_READING);
+            if (claimed) return true;
+            // Dropped by the producer while we were reading; take the next one
+        }
+    }
+
+    // Consumer side: polls with backoff until an item arrives, the queue is
+    // closed and drained, or the timeout expires
+    bool pop(T& out, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (int spins = 0;; spins++) {
+            if (tryPop(out)) return true;
+            if (closed_.load(std::memory_order_acquire)) return tryPop(out);
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            if (spins < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // No more pushes; pop() returns false once the remaining items are drained
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return capacity_; }
+    size_t depth() const {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+    uint64_t pushes() const { return pushes_.load(std::memory_order_relaxed); }
+    uint64_t drops() const { return drops_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t NOT_READING = ~0ull;
+
+    const size_t capacity_;
+    std::vector<T> slots_;  // one spare slot so a drop never reuses the slot being read
+
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> reading_{NOT_READING};
+    std::atomic<bool> closed_{false};
+    std::atomic<uint64_t> pushes_{0};
+    std::atomic<uint64_t> drops_{0};
+};
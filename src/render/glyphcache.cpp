@@ -0,0 +1,75 @@
+#include "glyphcache.h"
+#include <algorithm>
+
+GlyphCache::GlyphCache(size_t capacity) : capacity_(std::max<size_t>(2, capacity)) {}
+
+const Glyph& GlyphCache::get(const std::string& text, double scale, int thickness) {
+    // Scale is quantized to 1/1000 so near-equal doubles share a strip
+    key_.assign(text);
+    key_.push_back('\0');
+    key_.append(std::to_string(static_cast<int>(scale * 1000.0 + 0.5)));
+    key_.push_back('/');
+    key_.append(std::to_string(thickness));
+
+    auto found = index_.find(key_);
+    if (found != index_.end()) {
+        hits_++;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return found->second->glyph;
+    }
+
+    misses_++;
+    if (entries_.size() >= capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{key_, Glyph()});
+    rasterize(text, scale, thickness, entries_.front().glyph);
+    index_.emplace(key_, entries_.begin());
+    return entries_.front().glyph;
+}
+
+void GlyphCache::rasterize(const std::string& text, double scale, int thickness, Glyph& glyph) {
+    glyph.textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, scale, thickness, &glyph.baseline);
+    // Strokes reach past the reported extents by about the thickness
+    const int pad = thickness + 1;
+    glyph.origin = cv::Point(pad, pad + glyph.textSize.height);
+    glyph.alpha = cv::Mat::zeros(glyph.textSize.height + glyph.baseline + 2 * pad, glyph.textSize.width + 2 * pad, CV_8UC1);
+    cv::putText(glyph.alpha, text, glyph.origin, cv::FONT_HERSHEY_SIMPLEX, scale, cv::Scalar(255), thickness);
+}
+
+void GlyphCache::draw(cv::Mat& frame, const std::string& text, cv::Point org, double scale,
+                      const cv::Scalar& color, int thickness) {
+    blitGlyph(frame, get(text, scale, thickness), org, color);
+}
+
+cv::Size GlyphCache::textSize(const std::string& text, double scale, int thickness, int* baseline) {
+    const Glyph& glyph = get(text, scale, thickness);
+    if (baseline) *baseline = glyph.baseline;
+    return glyph.textSize;
+}
+
+void blitGlyph(cv::Mat& frame, const Glyph& glyph, cv::Point org, const cv::Scalar& color) {
+    const cv::Point topLeft(org.x - glyph.origin.x, org.y - glyph.origin.y);
+    cv::Rect area = cv::Rect(topLeft.x, topLeft.y, glyph.alpha.cols, glyph.alpha.rows) & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (area.width <= 0 || area.height <= 0) return;
+
+    const int c0 = static_cast<int>(color[0]), c1 = static_cast<int>(color[1]), c2 = static_cast<int>(color[2]);
+    for (int y = area.y; y < area.y + area.height; y++) {
+        const uchar* a = glyph.alpha.ptr<uchar>(y - topLeft.y) + (area.x - topLeft.x);
+        uchar* d = frame.ptr<uchar>(y) + 3 * area.x;
+        for (int x = 0; x < area.width; x++, d += 3) {
+            const int coverage = a[x];
+            if (coverage == 0) continue;
+            if (coverage == 255) {
+                d[0] = static_cast<uchar>(c0);
+                d[1] = static_cast<uchar>(c1);
+                d[2] = static_cast<uchar>(c2);
+                continue;
+            }
+            d[0] = static_cast<uchar>(d[0] + ((c0 - d[0]) * coverage + 127) / 255);
+            d[1] = static_cast<uchar>(d[1] + ((c1 - d[1]) * coverage + 127) / 255);
+            d[2] = static_cast<uchar>(d[2] + ((c2 - d[2]) * coverage + 127) / 255);
+        }
+    }
+}
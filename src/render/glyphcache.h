@@ -0,0 +1,58 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Text rasterized once with cv::putText into a coverage mask
+struct Glyph {
+    cv::Mat alpha;      // CV_8UC1 coverage strip
+    cv::Point origin;   // baseline-left point of the text inside the strip
+    cv::Size textSize;  // as cv::getTextSize reports it
+    int baseline = 0;
+};
+
+// LRU cache of rendered HUD and label text (FONT_HERSHEY_SIMPLEX).
+//
+// Strips are keyed by (text, scale, thickness) and hold coverage only, so the
+// same strip serves every colour: drawing is an alpha blit of the colour
+// through the mask instead of a fresh Hershey rasterization.
+class GlyphCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    explicit GlyphCache(size_t capacity = DEFAULT_CAPACITY);
+
+    const Glyph& get(const std::string& text, double scale, int thickness);
+
+    // cv::putText through the cache; org is the baseline-left corner.
+    // frame must be CV_8UC3.
+    void draw(cv::Mat& frame, const std::string& text, cv::Point org, double scale,
+              const cv::Scalar& color, int thickness);
+
+    // cv::getTextSize through the cache
+    cv::Size textSize(const std::string& text, double scale, int thickness, int* baseline);
+
+    size_t size() const { return entries_.size(); }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+private:
+    struct Entry {
+        std::string key;
+        Glyph glyph;
+    };
+
+    void rasterize(const std::string& text, double scale, int thickness, Glyph& glyph);
+
+    size_t capacity_;
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::string key_;           // reused lookup key
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+// Blend color into frame through glyph's coverage, with the glyph's origin at org
+void blitGlyph(cv::Mat& frame, const Glyph& glyph, cv::Point org, const cv::Scalar& color);
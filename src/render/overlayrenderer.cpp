@@ -0,0 +1,48 @@
+#include "overlayrenderer.h"
+#include <algorithm>
+
+void OverlayRenderer::drawDetections(cv::Mat& frame, const std::vector<Detection>& detections) {
+    const double frameArea = static_cast<double>(frame.rows) * frame.cols;
+    for (const Detection& det : detections) {
+        // Class-specific colors from the policy table
+        const uint8_t* bgr = policies_[det.classId].color;
+        cv::Scalar color(bgr[0], bgr[1], bgr[2]);
+
+        // Line thickness and text size follow the object size
+        int thickness = 2;
+        double fontScale = 0.6;
+        if (det.box.area() > frameArea * 0.1) {
+            thickness = 4;
+            fontScale = 1.0;
+        } else if (det.box.area() < frameArea * 0.01) {
+            thickness = 1;
+            fontScale = 0.4;
+        }
+        cv::rectangle(frame, det.box, color, thickness);
+
+        name_.assign(det.label());
+        name_.push_back(' ');
+        percent_ = std::to_string(static_cast<int>(det.score * 100));
+        percent_.push_back('%');
+        // The second get() cannot evict the first: it is the most recently used
+        const Glyph& name = glyphs_.get(name_, fontScale, LABEL_THICKNESS);
+        const Glyph& percent = glyphs_.get(percent_, fontScale, LABEL_THICKNESS);
+
+        // getTextSize pads every string by the stroke thickness; count it once
+        const int width = name.textSize.width + percent.textSize.width - LABEL_THICKNESS;
+        const int height = std::max(name.textSize.height, percent.textSize.height);
+        const int baseline = std::max(name.baseline, percent.baseline);
+
+        // Ensure text is within frame bounds
+        cv::Point textOrg(det.box.x, std::max(det.box.y - 5, height + 5));
+        cv::rectangle(frame,
+                      cv::Point(textOrg.x - 2, textOrg.y - height - baseline - 2),
+                      cv::Point(textOrg.x + width + 2, textOrg.y + baseline + 2),
+                      color, cv::FILLED);
+
+        // Text in contrasting color
+        const cv::Scalar white(255, 255, 255);
+        blitGlyph(frame, name, textOrg, white);
+        blitGlyph(frame, percent, cv::Point(textOrg.x + name.textSize.width - LABEL_THICKNESS, textOrg.y), white);
+    }
+}
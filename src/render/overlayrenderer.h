@@ -0,0 +1,38 @@
+#pragma once
+#include "glyphcache.h"
+#include "../vision/visionmodule.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Detection boxes, labels and HUD text drawn through a GlyphCache.
+//
+// A label is drawn as two cached strips, the class name and the confidence
+// percentage, so a changing score only ever needs one of about a hundred
+// percentage strips per font size and never re-rasterizes the name.
+class OverlayRenderer {
+public:
+    explicit OverlayRenderer(const ClassPolicyTable& policies) : policies_(policies) {}
+
+    // Class-coloured box and label per detection, sized by box area
+    void drawDetections(cv::Mat& frame, const std::vector<Detection>& detections);
+
+    // cv::putText / cv::getTextSize replacements for HUD lines
+    void text(cv::Mat& frame, const std::string& text, cv::Point org, double scale,
+              const cv::Scalar& color, int thickness = 1) {
+        glyphs_.draw(frame, text, org, scale, color, thickness);
+    }
+    cv::Size textSize(const std::string& text, double scale, int thickness, int* baseline) {
+        return glyphs_.textSize(text, scale, thickness, baseline);
+    }
+
+    const GlyphCache& glyphs() const { return glyphs_; }
+
+private:
+    static constexpr int LABEL_THICKNESS = 2;
+
+    const ClassPolicyTable& policies_;
+    GlyphCache glyphs_;
+    std::string name_;
+    std::string percent_;
+};
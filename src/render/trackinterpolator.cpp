@@ -0,0 +1,30 @@
+#include "trackinterpolator.h"
+#include <algorithm>
+
+void TrackInterpolator::push(const TrackSnapshot& snapshot) {
+    std::swap(previous_, latest_);
+    latest_ = snapshot;  // copy-assign keeps the tracks vector's capacity
+}
+
+void TrackInterpolator::boxesAt(std::chrono::steady_clock::time_point time, std::vector<Detection>& boxes) const {
+    boxes.assign(latest_.tracks.begin(), latest_.tracks.end());
+    if (!previous_.published() || !latest_.published()) return;
+
+    const double span = std::chrono::duration<double>(latest_.captured - previous_.captured).count();
+    if (span <= 0.0) return;
+    // -1..0 interpolates back towards the previous snapshot, 0..1 extrapolates
+    const double alpha = std::min(1.0, std::max(-1.0, std::chrono::duration<double>(time - latest_.captured).count() / span));
+    if (alpha == 0.0) return;
+
+    // Linear search: a display frame has tens of tracks, not thousands
+    for (Detection& det : boxes) {
+        if (det.trackId < 0) continue;
+        auto before = std::find_if(previous_.tracks.begin(), previous_.tracks.end(),
+                                   [&](const Detection& other) { return other.trackId == det.trackId; });
+        if (before == previous_.tracks.end()) continue;
+        const cv::Rect& a = before->box;
+        const cv::Rect b = det.box;
+        det.box = cv::Rect(cvRound(b.x + (b.x - a.x) * alpha), cvRound(b.y + (b.y - a.y) * alpha),
+                           cvRound(b.width + (b.width - a.width) * alpha), cvRound(b.height + (b.height - a.height) * alpha));
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "../pipeline/framepacket.h"
+#include <chrono>
+#include <vector>
+
+// Track boxes for display frames that arrive between tracker updates.
+//
+// The two latest snapshots give each track a box at two capture times; a
+// display frame is drawn with the boxes moved linearly to its own capture
+// time. Frames newer than the latest snapshot are extrapolated by at most one
+// snapshot interval, so a stalled detector freezes the boxes instead of
+// sending them off-screen. Tracks are matched by trackId.
+class TrackInterpolator {
+public:
+    // A newer snapshot; the current latest becomes the interpolation base
+    void push(const TrackSnapshot& snapshot);
+
+    // Boxes at capture time `time`; tracks without a previous position are
+    // drawn where the latest snapshot has them
+    void boxesAt(std::chrono::steady_clock::time_point time, std::vector<Detection>& boxes) const;
+
+    const TrackSnapshot& latest() const { return latest_; }
+
+private:
+    TrackSnapshot previous_;
+    TrackSnapshot latest_;
+};
@@ -0,0 +1,75 @@
+// Dumps preprocessed calibration tensors for INT8 quantization.
+//
+// Usage: calib_dump <image_dir> <out_dir> [max_images]
+//
+// Every image is letterboxed exactly like VisionModule does at runtime and
+// written as a raw float32 [3,640,640] tensor (<out_dir>/NNNNN.bin), which
+// tools/quantize_yolo.py feeds to the ONNX Runtime calibrator.
+#include "vision/preprocess.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static constexpr int INPUT_SIZE = 640;
+
+static bool isImage(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <image_dir> <out_dir> [max_images]" << std::endl;
+        return 1;
+    }
+    fs::path imageDir = argv[1];
+    fs::path outDir = argv[2];
+    size_t maxImages = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 500;
+
+    std::vector<fs::path> images;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(imageDir, ec)) {
+        if (entry.is_regular_file() && isImage(entry.path())) images.push_back(entry.path());
+    }
+    if (ec || images.empty()) {
+        std::cerr << "No calibration images found in " << imageDir << std::endl;
+        return 1;
+    }
+    std::sort(images.begin(), images.end());
+    if (images.size() > maxImages) images.resize(maxImages);
+
+    fs::create_directories(outDir, ec);
+    Preprocessor preprocessor(INPUT_SIZE, INPUT_SIZE);
+    std::vector<float> tensor(3 * INPUT_SIZE * INPUT_SIZE);
+    size_t written = 0;
+    for (const fs::path& path : images) {
+        cv::Mat frame = cv::imread(path.string(), cv::IMREAD_COLOR);
+        if (frame.empty()) {
+            std::cerr << "Skipping unreadable image " << path << std::endl;
+            continue;
+        }
+        preprocessor.run(frame, tensor.data());
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%05zu.bin", written);
+        std::ofstream out(outDir / name, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(tensor.data()),
+                  static_cast<std::streamsize>(tensor.size() * sizeof(float)));
+        if (!out) {
+            std::cerr << "Failed to write " << (outDir / name) << std::endl;
+            return 1;
+        }
+        written++;
+    }
+
+    std::cout << "Wrote " << written << " calibration tensors to " << outDir << std::endl;
+    return written > 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "assignment.h"
+#include <limits>
+
+void LinearAssignment::solve(const float* cost, int rows, int cols, std::vector<int>& rowMatch) {
+    rowMatch.assign(rows, -1);
+    if (rows == 0 || cols == 0) return;
+
+    // The potentials formulation needs n <= m: solve the transpose otherwise
+    const bool transpose = rows > cols;
+    const float* a = cost;
+    int n = rows, m = cols;
+    if (transpose) {
+        transposed_.resize(static_cast<size_t>(rows) * cols);
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) transposed_[static_cast<size_t>(c) * rows + r] = cost[static_cast<size_t>(r) * cols + c];
+        }
+        a = transposed_.data();
+        n = cols;
+        m = rows;
+    }
+
+    // 1-based: column 0 is the virtual start of each augmenting path
+    const double inf = std::numeric_limits<double>::infinity();
+    u_.assign(n + 1, 0.0);
+    v_.assign(m + 1, 0.0);
+    p_.assign(m + 1, 0);
+    way_.assign(m + 1, 0);
+    for (int i = 1; i <= n; i++) {
+        p_[0] = i;
+        int j0 = 0;
+        minv_.assign(m + 1, inf);
+        used_.assign(m + 1, 0);
+        do {
+            used_[j0] = 1;
+            const int i0 = p_[j0];
+            const float* row = a + static_cast<size_t>(i0 - 1) * m;
+            double delta = inf;
+            int j1 = 0;
+            for (int j = 1; j <= m; j++) {
+                if (used_[j]) continue;
+                double reduced = row[j - 1] - u_[i0] - v_[j];
+                if (reduced < minv_[j]) {
+                    minv_[j] = reduced;
+                    way_[j] = j0;
+                }
+                if (minv_[j] < delta) {
+                    delta = minv_[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (used_[j]) {
+                    u_[p_[j]] += delta;
+                    v_[j] -= delta;
+                } else {
+                    minv_[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p_[j0] != 0);
+        // Flip the augmenting path
+        do {
+            int j1 = way_[j0];
+            p_[j0] = p_[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (int j = 1; j <= m; j++) {
+        if (p_[j] == 0) continue;
+        int r = transpose ? j - 1 : p_[j] - 1;
+        int c = transpose ? p_[j] - 1 : j - 1;
+        if (cost[static_cast<size_t>(r) * cols + c] < INVALID_COST) rowMatch[r] = c;
+    }
+}
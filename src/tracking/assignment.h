@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Minimum-cost assignment of rows to columns (Hungarian method with row and
+// column potentials, O(n^2 m) for n <= m). Pairs whose cost is at least
+// INVALID_COST are never reported: with that as a large finite penalty the
+// solver first maximises the number of valid pairs, then minimises their cost.
+// Working memory is kept between calls, so steady-state solves do not allocate.
+class LinearAssignment {
+public:
+    static constexpr float INVALID_COST = 1e6f;
+
+    // cost is rows x cols, row-major. rowMatch[r] is the column assigned to
+    // row r, or -1.
+    void solve(const float* cost, int rows, int cols, std::vector<int>& rowMatch);
+
+private:
+    std::vector<float> transposed_;
+    std::vector<double> u_, v_, minv_;
+    std::vector<int> p_, way_;
+    std::vector<char> used_;
+};
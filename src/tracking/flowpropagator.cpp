@@ -0,0 +1,187 @@
+#include "flowpropagator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Median by partial sort; reorders values
+static float median(std::vector<float>& values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+FlowPropagator::FlowPropagator(const FlowPropagatorConfig& config) : config_(config) {}
+
+// Area-downscaled grey frame; scale_ maps frame coordinates onto it
+void FlowPropagator::prepare(const cv::Mat& frame, const cv::Size& frameSize) {
+    int width = std::min(config_.frameWidth, frame.cols);
+    int height = std::max(1, frame.rows * width / std::max(1, frame.cols));
+    cv::resize(frame, small_, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (small_.channels() == 3) cv::cvtColor(small_, grey_, cv::COLOR_BGR2GRAY);
+    else small_.copyTo(grey_);
+    scale_ = static_cast<float>(width) / static_cast<float>(std::max(1, frameSize.width));
+}
+
+void FlowPropagator::seed(const cv::Mat& frame, const cv::Size& frameSize, const std::vector<Detection>& detections,
+                          const std::vector<Detection>& boxes) {
+    prepare(frame, frameSize);
+    if (propagated_) {
+        // One more flow step so both sides of the comparison show this
+        // frame; its pyramid then also serves the new seed
+        step();
+        measureDrift(detections);
+    } else {
+        const cv::Size window(config_.windowSize, config_.windowSize);
+        cv::buildOpticalFlowPyramid(grey_, previousPyramid_, window, config_.pyramidLevels);
+    }
+
+    rects_.clear();
+    classIds_.clear();
+    scores_.clear();
+    trackIds_.clear();
+    points_.clear();
+    pointStart_.assign(1, 0);
+    for (const Detection& det : boxes) {
+        cv::Rect2f rect(static_cast<float>(det.box.x), static_cast<float>(det.box.y),
+                        static_cast<float>(det.box.width), static_cast<float>(det.box.height));
+        rects_.push_back(rect);
+        classIds_.push_back(det.classId);
+        scores_.push_back(det.score);
+        trackIds_.push_back(det.trackId);
+        addPoints(rect);
+    }
+    seeded_ = true;
+    propagated_ = false;
+}
+
+// Corners inside the box, or a 3x3 grid where it has too little texture
+void FlowPropagator::addPoints(const cv::Rect2f& box) {
+    cv::Rect roi(cvRound(box.x * scale_), cvRound(box.y * scale_), cvRound(box.width * scale_), cvRound(box.height * scale_));
+    roi &= cv::Rect(0, 0, grey_.cols, grey_.rows);
+    corners_.clear();
+    if (roi.width >= 4 && roi.height >= 4) {
+        cv::goodFeaturesToTrack(grey_(roi), corners_, config_.pointsPerBox, config_.minQuality, 2.0);
+    }
+    for (const cv::Point2f& corner : corners_) {
+        points_.push_back(cv::Point2f(corner.x + roi.x, corner.y + roi.y));
+    }
+    if (corners_.size() < 3 && roi.area() > 0) {
+        for (int gy = 1; gy <= 3; gy++) {
+            for (int gx = 1; gx <= 3; gx++) {
+                points_.push_back(cv::Point2f(roi.x + roi.width * gx / 4.0f, roi.y + roi.height * gy / 4.0f));
+            }
+        }
+    }
+    pointStart_.push_back(static_cast<int>(points_.size()));
+}
+
+bool FlowPropagator::propagate(const cv::Mat& frame, const cv::Size& frameSize, std::vector<Detection>& boxes) {
+    if (!seeded_) return false;
+    auto start = std::chrono::steady_clock::now();
+
+    prepare(frame, frameSize);
+    step();
+
+    boxes.clear();
+    for (size_t i = 0; i < rects_.size(); i++) {
+        const cv::Rect2f& rect = rects_[i];
+        boxes.push_back({classIds_[i], scores_[i],
+                         cv::Rect(cvRound(rect.x), cvRound(rect.y), cvRound(rect.width), cvRound(rect.height)), trackIds_[i]});
+    }
+
+    stats_.lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats_.totalMs += stats_.lastMs;
+    stats_.propagatedFrames++;
+    return true;
+}
+
+// Follows the points from the previous pyramid into the prepared frame and
+// moves the boxes with them; the new pyramid becomes the previous one
+void FlowPropagator::step() {
+    const cv::Size window(config_.windowSize, config_.windowSize);
+    cv::buildOpticalFlowPyramid(grey_, pyramid_, window, config_.pyramidLevels);
+    if (!points_.empty()) {
+        cv::calcOpticalFlowPyrLK(previousPyramid_, pyramid_, points_, nextPoints_, status_, error_,
+                                 window, config_.pyramidLevels);
+    }
+    for (size_t i = 0; i < rects_.size(); i++) moveBox(i);
+    points_.swap(nextPoints_);
+    previousPyramid_.swap(pyramid_);
+    propagated_ = true;
+}
+
+// Median shift and median pairwise-distance ratio of the points that were
+// found again; lost points follow the box so they can be recovered later
+void FlowPropagator::moveBox(size_t index) {
+    const int begin = pointStart_[index], end = pointStart_[index + 1];
+    dx_.clear();
+    dy_.clear();
+    for (int p = begin; p < end; p++) {
+        if (!status_[p]) continue;
+        dx_.push_back(nextPoints_[p].x - points_[p].x);
+        dy_.push_back(nextPoints_[p].y - points_[p].y);
+    }
+    if (dx_.size() < 2) {
+        for (int p = begin; p < end; p++) nextPoints_[p] = points_[p];
+        return;
+    }
+    const float shiftX = median(dx_), shiftY = median(dy_);
+
+    ratios_.clear();
+    for (int p = begin; p < end; p++) {
+        if (!status_[p]) continue;
+        for (int q = p + 1; q < end; q++) {
+            if (!status_[q]) continue;
+            float before = std::hypot(points_[p].x - points_[q].x, points_[p].y - points_[q].y);
+            if (before < 1.0f) continue;
+            ratios_.push_back(std::hypot(nextPoints_[p].x - nextPoints_[q].x, nextPoints_[p].y - nextPoints_[q].y) / before);
+        }
+    }
+    float scale = ratios_.empty() ? 1.0f : median(ratios_);
+    scale = std::min(config_.maxScaleStep, std::max(1.0f / config_.maxScaleStep, scale));
+
+    for (int p = begin; p < end; p++) {
+        if (!status_[p]) nextPoints_[p] = cv::Point2f(points_[p].x + shiftX, points_[p].y + shiftY);
+    }
+
+    cv::Rect2f& rect = rects_[index];
+    float cx = rect.x + 0.5f * rect.width + shiftX / scale_;
+    float cy = rect.y + 0.5f * rect.height + shiftY / scale_;
+    rect.width *= scale;
+    rect.height *= scale;
+    rect.x = cx - 0.5f * rect.width;
+    rect.y = cy - 0.5f * rect.height;
+}
+
+// Each propagated box against the best-overlapping same-class box of the
+// frame that ended the propagation
+void FlowPropagator::measureDrift(const std::vector<Detection>& detections) {
+    for (size_t i = 0; i < rects_.size(); i++) {
+        const cv::Rect2f& a = rects_[i];
+        float bestIou = 0.0f;
+        const Detection* best = nullptr;
+        for (const Detection& det : detections) {
+            if (det.classId != classIds_[i]) continue;
+            const cv::Rect& b = det.box;
+            float w = std::min(a.x + a.width, static_cast<float>(b.x + b.width)) - std::max(a.x, static_cast<float>(b.x));
+            float h = std::min(a.y + a.height, static_cast<float>(b.y + b.height)) - std::max(a.y, static_cast<float>(b.y));
+            if (w <= 0.0f || h <= 0.0f) continue;
+            float inter = w * h;
+            float iou = inter / (a.width * a.height + static_cast<float>(b.area()) - inter);
+            if (iou > bestIou) {
+                bestIou = iou;
+                best = &det;
+            }
+        }
+        if (!best) {
+            stats_.lostBoxes++;
+            continue;
+        }
+        float diagonal = std::max(1.0f, std::hypot(a.width, a.height));
+        float dx = best->box.x + 0.5f * best->box.width - (a.x + 0.5f * a.width);
+        float dy = best->box.y + 0.5f * best->box.height - (a.y + 0.5f * a.height);
+        stats_.driftSamples++;
+        stats_.totalIou += bestIou;
+        stats_.totalDrift += std::hypot(dx, dy) / diagonal;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "../vision/visionmodule.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+struct FlowPropagatorConfig {
+    int frameWidth = 320;       // flow runs on a grey frame downscaled to this width
+    int pointsPerBox = 12;      // feature points tracked inside each box
+    int windowSize = 15;        // LK window side, in downscaled pixels
+    int pyramidLevels = 2;
+    float minQuality = 0.01f;   // goodFeaturesToTrack quality level
+    float maxScaleStep = 1.2f;  // largest box scale change accepted per frame
+};
+
+struct FlowStats {
+    uint64_t propagatedFrames = 0;
+    double lastMs = 0.0;         // flow cost of the latest propagated frame
+    double totalMs = 0.0;
+    uint64_t driftSamples = 0;   // propagated boxes compared with the next detection
+    double totalDrift = 0.0;     // centre error, in box diagonals
+    double totalIou = 0.0;
+    uint64_t lostBoxes = 0;      // propagated boxes no same-class detection overlapped
+
+    double meanMs() const { return propagatedFrames ? totalMs / propagatedFrames : 0.0; }
+    double meanDrift() const { return driftSamples ? totalDrift / driftSamples : 0.0; }
+    double meanIou() const { return driftSamples ? totalIou / driftSamples : 0.0; }
+};
+
+// Moves tracked boxes between detector frames with sparse optical flow.
+//
+// On a detector frame a few corners are picked inside each box on a small
+// grey frame; on the frames in between they are followed with pyramidal
+// Lucas-Kanade and each box moves by the median point displacement and scales
+// by the median change of pairwise point distances, which ignores points that
+// slid onto the background. Each frame's pyramid is built once and reused as
+// the previous pyramid of the next frame. On the next detector frame the
+// propagated boxes are moved onto it too and scored against the raw
+// detections (drift statistics), so the score is flow error alone.
+class FlowPropagator {
+public:
+    explicit FlowPropagator(const FlowPropagatorConfig& config = FlowPropagatorConfig());
+
+    // Detector frame: score the propagated boxes, moved on to this frame,
+    // against the raw detections, then restart the flow from boxes (the
+    // tracker output). frameSize is the size box coordinates refer to.
+    void seed(const cv::Mat& frame, const cv::Size& frameSize, const std::vector<Detection>& detections,
+              const std::vector<Detection>& boxes);
+
+    // Frame without detections: boxes receives the seeded boxes moved by the
+    // flow so far. False, leaving boxes untouched, before the first seed.
+    bool propagate(const cv::Mat& frame, const cv::Size& frameSize, std::vector<Detection>& boxes);
+
+    const FlowPropagatorConfig& config() const { return config_; }
+    const FlowStats& stats() const { return stats_; }
+
+private:
+    void prepare(const cv::Mat& frame, const cv::Size& frameSize);
+    void step();
+    void addPoints(const cv::Rect2f& box);
+    void moveBox(size_t index);
+    void measureDrift(const std::vector<Detection>& detections);
+
+    FlowPropagatorConfig config_;
+    FlowStats stats_;
+    cv::Mat small_;
+    cv::Mat grey_;
+    std::vector<cv::Mat> pyramid_;
+    std::vector<cv::Mat> previousPyramid_;
+    float scale_ = 1.0f;  // grey pixels per frame pixel
+
+    // Boxes in frame coordinates, and their points (grey coordinates) as
+    // consecutive runs: box i owns points [pointStart_[i], pointStart_[i + 1])
+    std::vector<cv::Rect2f> rects_;
+    std::vector<int> classIds_;
+    std::vector<float> scores_;
+    std::vector<int> trackIds_;
+    std::vector<int> pointStart_;
+    std::vector<cv::Point2f> points_;
+    std::vector<cv::Point2f> nextPoints_;
+    std::vector<uchar> status_;
+    std::vector<float> error_;
+    std::vector<cv::Point2f> corners_;
+    std::vector<float> dx_, dy_, ratios_;
+    bool seeded_ = false;
+    bool propagated_ = false;  // boxes moved since the last seed
+};
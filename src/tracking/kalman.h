@@ -0,0 +1,92 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+
+// Constant-velocity Kalman filter over one box coordinate. The state is
+// (position, velocity) per frame step; the symmetric 2x2 covariance is kept
+// as its three distinct terms.
+struct KalmanAxis {
+    float x = 0.0f;  // position
+    float v = 0.0f;  // velocity, per frame
+    float p00 = 0.0f, p01 = 0.0f, p11 = 0.0f;
+
+    void init(float position, float positionVar, float velocityVar) {
+        x = position;
+        v = 0.0f;
+        p00 = positionVar;
+        p01 = 0.0f;
+        p11 = velocityVar;
+    }
+
+    // x' = F x, P' = F P F^T + diag(qPos, qVel) with F = [1 1; 0 1]
+    void predict(float qPos, float qVel) {
+        x += v;
+        p00 += 2.0f * p01 + p11 + qPos;
+        p01 += p11;
+        p11 += qVel;
+    }
+
+    // Position measurement z with variance r
+    void update(float z, float r) {
+        float s = p00 + r;
+        float k0 = p00 / s, k1 = p01 / s;
+        float y = z - x;
+        x += k0 * y;
+        v += k1 * y;
+        p11 -= k1 * p01;
+        p01 *= 1.0f - k0;
+        p00 *= 1.0f - k0;
+    }
+};
+
+// Noise levels relative to the box height, as in SORT/ByteTrack: a large box
+// moves and jitters by more pixels than a small one
+struct KalmanNoise {
+    float position = 1.0f / 20.0f;     // process noise on centre and size
+    float velocity = 1.0f / 160.0f;    // process noise on their rates
+    float measurement = 1.0f / 20.0f;  // detector jitter
+};
+
+// Box tracked as four independent constant-velocity axes: centre x/y and
+// width/height. With diagonal noise the axes do not interact, so this is the
+// exact 8-state filter at a fraction of the cost and without a matrix library.
+class KalmanBox {
+public:
+    void init(const cv::Rect& box, const KalmanNoise& noise) {
+        float scale = std::max(1.0f, static_cast<float>(box.height));
+        float posVar = square(2.0f * noise.position * scale);
+        float velVar = square(10.0f * noise.velocity * scale);
+        cx_.init(box.x + 0.5f * box.width, posVar, velVar);
+        cy_.init(box.y + 0.5f * box.height, posVar, velVar);
+        w_.init(static_cast<float>(box.width), posVar, velVar);
+        h_.init(static_cast<float>(box.height), posVar, velVar);
+    }
+
+    // Advance one frame step
+    void predict(const KalmanNoise& noise) {
+        float scale = std::max(1.0f, h_.x);
+        float qPos = square(noise.position * scale), qVel = square(noise.velocity * scale);
+        cx_.predict(qPos, qVel);
+        cy_.predict(qPos, qVel);
+        w_.predict(qPos, qVel);
+        h_.predict(qPos, qVel);
+    }
+
+    void update(const cv::Rect& box, const KalmanNoise& noise) {
+        float r = square(noise.measurement * std::max(1.0f, h_.x));
+        cx_.update(box.x + 0.5f * box.width, r);
+        cy_.update(box.y + 0.5f * box.height, r);
+        w_.update(static_cast<float>(box.width), r);
+        h_.update(static_cast<float>(box.height), r);
+    }
+
+    cv::Rect box() const {
+        float w = std::max(1.0f, w_.x), h = std::max(1.0f, h_.x);
+        return cv::Rect(cvRound(cx_.x - 0.5f * w), cvRound(cy_.x - 0.5f * h), cvRound(w), cvRound(h));
+    }
+
+private:
+    static float square(float value) { return value * value; }
+
+    KalmanAxis cx_, cy_, w_, h_;
+};
@@ -0,0 +1,156 @@
+#include "trackcost.h"
+#include "assignment.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX__)
+#include <immintrin.h>
+#define TRACK_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRACK_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TRACK_NEON 1
+#endif
+
+void TrackBoxColumns::reserve(size_t count) {
+    for (std::vector<float>* column : {&x1, &y1, &x2, &y2, &area, &cx, &cy, &invDiagonal, &classId}) {
+        column->reserve(count);
+    }
+}
+
+void TrackBoxColumns::push(const cv::Rect& box, int cls) {
+    for (std::vector<float>* column : {&x1, &y1, &x2, &y2, &area, &cx, &cy, &invDiagonal}) {
+        column->push_back(0.0f);
+    }
+    classId.push_back(static_cast<float>(cls));
+    set(size() - 1, box);
+}
+
+void TrackBoxColumns::set(size_t i, const cv::Rect& box) {
+    x1[i] = static_cast<float>(box.x);
+    y1[i] = static_cast<float>(box.y);
+    x2[i] = static_cast<float>(box.x + box.width);
+    y2[i] = static_cast<float>(box.y + box.height);
+    area[i] = static_cast<float>(box.area());
+    cx[i] = box.x + 0.5f * box.width;
+    cy[i] = box.y + 0.5f * box.height;
+    invDiagonal[i] = 1.0f / std::max(1.0f, std::sqrt(static_cast<float>(box.width * box.width + box.height * box.height)));
+}
+
+void TrackBoxColumns::remove(size_t i) {
+    for (std::vector<float>* column : {&x1, &y1, &x2, &y2, &area, &cx, &cy, &invDiagonal, &classId}) {
+        (*column)[i] = column->back();
+        column->pop_back();
+    }
+}
+
+void trackCostRow(const cv::Rect& box, int classId, const TrackBoxColumns& tracks,
+                  float iouThreshold, float maxCenterDistance, float* out) {
+    const float bx1 = static_cast<float>(box.x), by1 = static_cast<float>(box.y);
+    const float bx2 = static_cast<float>(box.x + box.width), by2 = static_cast<float>(box.y + box.height);
+    const float bArea = static_cast<float>(box.area());
+    const float bcx = box.x + 0.5f * box.width, bcy = box.y + 0.5f * box.height;
+    const float cls = static_cast<float>(classId);
+    const float invalid = LinearAssignment::INVALID_COST;
+
+    const float* x1 = tracks.x1.data();
+    const float* y1 = tracks.y1.data();
+    const float* x2 = tracks.x2.data();
+    const float* y2 = tracks.y2.data();
+    const float* area = tracks.area.data();
+    const float* cx = tracks.cx.data();
+    const float* cy = tracks.cy.data();
+    const float* invDiagonal = tracks.invDiagonal.data();
+    const float* trackClass = tracks.classId.data();
+    const int n = static_cast<int>(tracks.size());
+
+    int i = 0;
+#if defined(TRACK_AVX)
+    const __m256 vbx1 = _mm256_set1_ps(bx1), vby1 = _mm256_set1_ps(by1);
+    const __m256 vbx2 = _mm256_set1_ps(bx2), vby2 = _mm256_set1_ps(by2);
+    const __m256 varea = _mm256_set1_ps(bArea), vcx = _mm256_set1_ps(bcx), vcy = _mm256_set1_ps(bcy);
+    const __m256 vcls = _mm256_set1_ps(cls), vinvalid = _mm256_set1_ps(invalid);
+    const __m256 viou = _mm256_set1_ps(iouThreshold), vdist = _mm256_set1_ps(maxCenterDistance);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 w = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vbx2, _mm256_loadu_ps(x2 + i)),
+                                                     _mm256_max_ps(vbx1, _mm256_loadu_ps(x1 + i))));
+        __m256 h = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vby2, _mm256_loadu_ps(y2 + i)),
+                                                     _mm256_max_ps(vby1, _mm256_loadu_ps(y1 + i))));
+        __m256 inter = _mm256_mul_ps(w, h);
+        __m256 uni = _mm256_sub_ps(_mm256_add_ps(varea, _mm256_loadu_ps(area + i)), inter);
+        __m256 iou = _mm256_and_ps(_mm256_cmp_ps(uni, zero, _CMP_GT_OQ), _mm256_div_ps(inter, uni));
+        __m256 dx = _mm256_sub_ps(vcx, _mm256_loadu_ps(cx + i));
+        __m256 dy = _mm256_sub_ps(vcy, _mm256_loadu_ps(cy + i));
+        __m256 dist = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))),
+                                    _mm256_loadu_ps(invDiagonal + i));
+        __m256 gate = _mm256_or_ps(_mm256_cmp_ps(iou, viou, _CMP_GE_OQ), _mm256_cmp_ps(dist, vdist, _CMP_LE_OQ));
+        __m256 valid = _mm256_and_ps(gate, _mm256_cmp_ps(_mm256_loadu_ps(trackClass + i), vcls, _CMP_EQ_OQ));
+        __m256 cost = _mm256_add_ps(_mm256_sub_ps(one, iou), dist);
+        _mm256_storeu_ps(out + i, _mm256_blendv_ps(vinvalid, cost, valid));
+    }
+#elif defined(TRACK_SSE2)
+    const __m128 vbx1 = _mm_set1_ps(bx1), vby1 = _mm_set1_ps(by1);
+    const __m128 vbx2 = _mm_set1_ps(bx2), vby2 = _mm_set1_ps(by2);
+    const __m128 varea = _mm_set1_ps(bArea), vcx = _mm_set1_ps(bcx), vcy = _mm_set1_ps(bcy);
+    const __m128 vcls = _mm_set1_ps(cls), vinvalid = _mm_set1_ps(invalid);
+    const __m128 viou = _mm_set1_ps(iouThreshold), vdist = _mm_set1_ps(maxCenterDistance);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 w = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(vbx2, _mm_loadu_ps(x2 + i)),
+                                               _mm_max_ps(vbx1, _mm_loadu_ps(x1 + i))));
+        __m128 h = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(vby2, _mm_loadu_ps(y2 + i)),
+                                               _mm_max_ps(vby1, _mm_loadu_ps(y1 + i))));
+        __m128 inter = _mm_mul_ps(w, h);
+        __m128 uni = _mm_sub_ps(_mm_add_ps(varea, _mm_loadu_ps(area + i)), inter);
+        __m128 iou = _mm_and_ps(_mm_cmpgt_ps(uni, zero), _mm_div_ps(inter, uni));
+        __m128 dx = _mm_sub_ps(vcx, _mm_loadu_ps(cx + i));
+        __m128 dy = _mm_sub_ps(vcy, _mm_loadu_ps(cy + i));
+        __m128 dist = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))),
+                                 _mm_loadu_ps(invDiagonal + i));
+        __m128 gate = _mm_or_ps(_mm_cmpge_ps(iou, viou), _mm_cmple_ps(dist, vdist));
+        __m128 valid = _mm_and_ps(gate, _mm_cmpeq_ps(_mm_loadu_ps(trackClass + i), vcls));
+        __m128 cost = _mm_add_ps(_mm_sub_ps(one, iou), dist);
+        _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(valid, cost), _mm_andnot_ps(valid, vinvalid)));
+    }
+#elif defined(TRACK_NEON)
+    const float32x4_t vbx1 = vdupq_n_f32(bx1), vby1 = vdupq_n_f32(by1);
+    const float32x4_t vbx2 = vdupq_n_f32(bx2), vby2 = vdupq_n_f32(by2);
+    const float32x4_t varea = vdupq_n_f32(bArea), vcx = vdupq_n_f32(bcx), vcy = vdupq_n_f32(bcy);
+    const float32x4_t vcls = vdupq_n_f32(cls), vinvalid = vdupq_n_f32(invalid);
+    const float32x4_t viou = vdupq_n_f32(iouThreshold), vdist = vdupq_n_f32(maxCenterDistance);
+    const float32x4_t zero = vdupq_n_f32(0.0f), one = vdupq_n_f32(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t w = vmaxq_f32(zero, vsubq_f32(vminq_f32(vbx2, vld1q_f32(x2 + i)),
+                                                  vmaxq_f32(vbx1, vld1q_f32(x1 + i))));
+        float32x4_t h = vmaxq_f32(zero, vsubq_f32(vminq_f32(vby2, vld1q_f32(y2 + i)),
+                                                  vmaxq_f32(vby1, vld1q_f32(y1 + i))));
+        float32x4_t inter = vmulq_f32(w, h);
+        float32x4_t uni = vsubq_f32(vaddq_f32(varea, vld1q_f32(area + i)), inter);
+        uint32x4_t positive = vcgtq_f32(uni, zero);
+        float32x4_t iou = vdivq_f32(inter, vbslq_f32(positive, uni, one));
+        iou = vreinterpretq_f32_u32(vandq_u32(positive, vreinterpretq_u32_f32(iou)));
+        float32x4_t dx = vsubq_f32(vcx, vld1q_f32(cx + i));
+        float32x4_t dy = vsubq_f32(vcy, vld1q_f32(cy + i));
+        float32x4_t dist = vmulq_f32(vsqrtq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy))),
+                                     vld1q_f32(invDiagonal + i));
+        uint32x4_t gate = vorrq_u32(vcgeq_f32(iou, viou), vcleq_f32(dist, vdist));
+        uint32x4_t valid = vandq_u32(gate, vceqq_f32(vld1q_f32(trackClass + i), vcls));
+        float32x4_t cost = vaddq_f32(vsubq_f32(one, iou), dist);
+        vst1q_f32(out + i, vbslq_f32(valid, cost, vinvalid));
+    }
+#endif
+    for (; i < n; i++) {
+        float w = std::max(0.0f, std::min(bx2, x2[i]) - std::max(bx1, x1[i]));
+        float h = std::max(0.0f, std::min(by2, y2[i]) - std::max(by1, y1[i]));
+        float inter = w * h;
+        float uni = bArea + area[i] - inter;
+        float iou = (uni > 0) ? inter / uni : 0.0f;
+        float dx = bcx - cx[i], dy = bcy - cy[i];
+        float dist = std::sqrt(dx * dx + dy * dy) * invDiagonal[i];
+        bool valid = trackClass[i] == cls && (iou >= iouThreshold || dist <= maxCenterDistance);
+        out[i] = valid ? (1.0f - iou) + dist : invalid;
+    }
+}
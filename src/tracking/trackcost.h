@@ -0,0 +1,26 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <vector>
+
+// Predicted track boxes as structure-of-arrays: the columns the cost kernel
+// streams with SIMD, one lane per track. Removal swaps in the last track.
+struct TrackBoxColumns {
+    std::vector<float> x1, y1, x2, y2, area;
+    std::vector<float> cx, cy, invDiagonal;
+    std::vector<float> classId;  // exact for class ids, compared in float lanes
+
+    size_t size() const { return x1.size(); }
+    void reserve(size_t count);
+    void push(const cv::Rect& box, int cls);
+    void set(size_t i, const cv::Rect& box);
+    void remove(size_t i);
+};
+
+// Assignment cost of one detection against every track, out[0..tracks.size()):
+// (1 - IoU) plus the centre distance over the track's box diagonal for
+// same-class pairs that reach iouThreshold or lie within maxCenterDistance,
+// LinearAssignment::INVALID_COST for every other pair. classId < 0 matches
+// no track.
+void trackCostRow(const cv::Rect& box, int classId, const TrackBoxColumns& tracks,
+                  float iouThreshold, float maxCenterDistance, float* out);
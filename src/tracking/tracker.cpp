@@ -0,0 +1,171 @@
+#include "tracker.h"
+
+SimpleTracker::SimpleTracker(const TrackerConfig& config) : config_(config) {}
+
+void SimpleTracker::predict() {
+    for (size_t t = 0; t < ids_.size(); t++) {
+        filters_[t].predict(config_.noise);
+        boxes_[t] = filters_[t].box();
+        columns_.set(t, boxes_[t]);
+    }
+}
+
+void SimpleTracker::addTrack(const Detection& detection) {
+    filters_.emplace_back();
+    filters_.back().init(detection.box, config_.noise);
+    boxes_.push_back(detection.box);
+    columns_.push(detection.box, detection.classId);
+    classIds_.push_back(detection.classId);
+    confidences_.push_back(detection.score);
+    missedFrames_.push_back(0);
+    ids_.push_back(nextId++);
+}
+
+// Swap-remove: the last track takes this slot in every column
+void SimpleTracker::removeTrack(size_t index) {
+    filters_[index] = filters_.back();
+    filters_.pop_back();
+    boxes_[index] = boxes_.back();
+    boxes_.pop_back();
+    classIds_[index] = classIds_.back();
+    classIds_.pop_back();
+    confidences_[index] = confidences_.back();
+    confidences_.pop_back();
+    missedFrames_[index] = missedFrames_.back();
+    missedFrames_.pop_back();
+    ids_[index] = ids_.back();
+    ids_.pop_back();
+    columns_.remove(index);
+}
+
+void SimpleTracker::updateTracks(const std::vector<Detection>& newDetections, std::vector<Detection>& tracked) {
+    predict();
+    buildCosts(newDetections);
+    assign(static_cast<int>(newDetections.size()));
+
+    tracked.clear();
+    for (size_t t = 0; t < ids_.size(); t++) {
+        int match = trackMatch_[t];
+        if (match < 0) {
+            missedFrames_[t]++;
+            continue;
+        }
+        const Detection& det = newDetections[match];
+        filters_[t].update(det.box, config_.noise);
+        boxes_[t] = filters_[t].box();
+        columns_.set(t, boxes_[t]);
+        confidences_[t] = det.score;
+        missedFrames_[t] = 0;
+        tracked.push_back({classIds_[t], confidences_[t], boxes_[t], ids_[t]});
+    }
+
+    // Remove lost tracks; order does not matter to a global assignment
+    for (size_t t = 0; t < ids_.size();) {
+        if (missedFrames_[t] > config_.maxMissedFrames) removeTrack(t);
+        else t++;
+    }
+
+    // Add new tracks for unmatched detections
+    for (size_t i = 0; i < newDetections.size(); i++) {
+        if (detectionMatched_[i] || !classFilter_.allows(newDetections[i].classId)) continue;
+        addTrack(newDetections[i]);
+        tracked.push_back(newDetections[i]);
+        tracked.back().trackId = ids_.back();
+    }
+}
+
+void SimpleTracker::predictTracks(std::vector<Detection>& tracked) {
+    predict();
+    tracked.clear();
+    for (size_t t = 0; t < ids_.size(); t++) {
+        if (missedFrames_[t] == 0) tracked.push_back({classIds_[t], confidences_[t], boxes_[t], ids_[t]});
+    }
+}
+
+// Dense detections x tracks cost matrix, one SIMD row per detection; gated
+// pairs also join the union-find so assign() can split the problem into
+// independent clusters
+void SimpleTracker::buildCosts(const std::vector<Detection>& detections) {
+    const int trackCount = static_cast<int>(ids_.size());
+    const int detectionCount = static_cast<int>(detections.size());
+    cost_.resize(static_cast<size_t>(trackCount) * detectionCount);
+    parent_.resize(trackCount + detectionCount);
+    for (int i = 0; i < trackCount + detectionCount; i++) parent_[i] = i;
+
+    for (int d = 0; d < detectionCount; d++) {
+        const Detection& det = detections[d];
+        float* row = cost_.data() + static_cast<size_t>(d) * trackCount;
+        // A filtered-out class matches no track
+        int classId = classFilter_.allows(det.classId) ? det.classId : -1;
+        trackCostRow(det.box, classId, columns_, config_.iouThreshold, config_.maxCenterDistance, row);
+        for (int t = 0; t < trackCount; t++) {
+            if (row[t] >= LinearAssignment::INVALID_COST) continue;
+            int ra = findRoot(t), rb = findRoot(trackCount + d);
+            if (ra != rb) parent_[ra] = rb;
+        }
+    }
+}
+
+int SimpleTracker::findRoot(int node) {
+    while (parent_[node] != node) {
+        parent_[node] = parent_[parent_[node]];  // path halving
+        node = parent_[node];
+    }
+    return node;
+}
+
+// Groups tracks and detections by cluster (counting sort on the root node)
+// and solves each cluster on its own
+void SimpleTracker::assign(int detectionCount) {
+    const int trackCount = static_cast<int>(ids_.size());
+    const int nodes = trackCount + detectionCount;
+    trackMatch_.assign(trackCount, -1);
+    detectionMatched_.assign(detectionCount, 0);
+    if (trackCount == 0 || detectionCount == 0) return;
+
+    rowStart_.assign(nodes + 1, 0);
+    colStart_.assign(nodes + 1, 0);
+    for (int t = 0; t < trackCount; t++) rowStart_[findRoot(t) + 1]++;
+    for (int d = 0; d < detectionCount; d++) colStart_[findRoot(trackCount + d) + 1]++;
+    for (int i = 0; i < nodes; i++) {
+        rowStart_[i + 1] += rowStart_[i];
+        colStart_[i + 1] += colStart_[i];
+    }
+    rowFill_.assign(rowStart_.begin(), rowStart_.end());
+    colFill_.assign(colStart_.begin(), colStart_.end());
+    componentRows_.resize(trackCount);
+    componentCols_.resize(detectionCount);
+    for (int t = 0; t < trackCount; t++) componentRows_[rowFill_[findRoot(t)]++] = t;
+    for (int d = 0; d < detectionCount; d++) componentCols_[colFill_[findRoot(trackCount + d)]++] = d;
+
+    for (int root = 0; root < nodes; root++) {
+        const int* rows = componentRows_.data() + rowStart_[root];
+        const int* cols = componentCols_.data() + colStart_[root];
+        const int rowCount = rowStart_[root + 1] - rowStart_[root];
+        const int colCount = colStart_[root + 1] - colStart_[root];
+        if (rowCount == 0 || colCount == 0) continue;
+
+        // A lone gated pair needs no solver
+        if (rowCount == 1 && colCount == 1) {
+            trackMatch_[rows[0]] = cols[0];
+            detectionMatched_[cols[0]] = 1;
+            continue;
+        }
+
+        subCost_.resize(static_cast<size_t>(rowCount) * colCount);
+        for (int c = 0; c < colCount; c++) {
+            const float* full = cost_.data() + static_cast<size_t>(cols[c]) * trackCount;
+            for (int r = 0; r < rowCount; r++) subCost_[static_cast<size_t>(r) * colCount + c] = full[rows[r]];
+        }
+        solver_.solve(subCost_.data(), rowCount, colCount, subMatch_);
+        for (int r = 0; r < rowCount; r++) {
+            if (subMatch_[r] < 0) continue;
+            trackMatch_[rows[r]] = cols[subMatch_[r]];
+            detectionMatched_[cols[subMatch_[r]]] = 1;
+        }
+    }
+}
+
+void SimpleTracker::trackBoxes(std::vector<cv::Rect>& boxes) const {
+    boxes.assign(boxes_.begin(), boxes_.end());
+}
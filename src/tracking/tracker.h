@@ -0,0 +1,84 @@
+#pragma once
+#include "../vision/visionmodule.h"
+#include "kalman.h"
+#include "assignment.h"
+#include "trackcost.h"
+#include <vector>
+
+struct TrackerConfig {
+    float iouThreshold = 0.3f;       // IoU with the predicted box that always allows a match
+    float maxCenterDistance = 0.5f;  // ... or centre distance, as a fraction of the predicted box diagonal
+    int maxMissedFrames = 5;         // frames a track coasts on its prediction before it is dropped
+    KalmanNoise noise;
+};
+
+// Multi-object tracker: a constant-velocity Kalman filter per track and a
+// globally optimal same-class assignment of detections to predicted boxes.
+//
+// The cost of a pair is (1 - IoU) plus the centre distance relative to the
+// predicted box diagonal; pairs passing neither the IoU nor the distance gate
+// are never matched. Gated pairs split tracks and detections into independent
+// clusters, and each cluster is solved with the Hungarian method, so a crowd
+// of hundreds of tracks costs many small solves rather than one large one.
+//
+// Tracks are stored as structure-of-arrays with swap-remove deletion. The
+// predicted boxes feed a SIMD kernel that fills one detection row of the cost
+// matrix per pass, with class and gate tests folded in. Tracks, cost matrix and
+// solver memory are reused between frames.
+class SimpleTracker {
+public:
+    explicit SimpleTracker(const TrackerConfig& config = TrackerConfig());
+
+    // One frame step with detections. tracked receives the matched tracks'
+    // filtered boxes and the detections that started new tracks.
+    void updateTracks(const std::vector<Detection>& newDetections, std::vector<Detection>& tracked);
+
+    // One frame step without detections (detector skipped the frame): every
+    // track moves to its predicted box and is not counted as missed. tracked
+    // receives the tracks that were matched on the last update.
+    void predictTracks(std::vector<Detection>& tracked);
+
+    // Detections of classes outside the filter never start or update a track
+    void setClassFilter(const ClassFilter& filter) { classFilter_ = filter; }
+
+    // Boxes of every live track, including ones missed on recent frames
+    void trackBoxes(std::vector<cv::Rect>& boxes) const;
+    size_t trackCount() const { return ids_.size(); }
+    int tracksStarted() const { return nextId; }
+
+    const TrackerConfig& config() const { return config_; }
+
+private:
+    void predict();
+    void addTrack(const Detection& detection);
+    void removeTrack(size_t index);
+    void buildCosts(const std::vector<Detection>& detections);
+    void assign(int detectionCount);
+    int findRoot(int node);
+
+    TrackerConfig config_;
+    ClassFilter classFilter_;
+    int nextId = 0;
+
+    // Live tracks, one entry per track in every column
+    TrackBoxColumns columns_;          // current boxes, as read by the cost kernel
+    std::vector<KalmanBox> filters_;
+    std::vector<cv::Rect> boxes_;      // predicted, then corrected when matched
+    std::vector<int> classIds_;
+    std::vector<float> confidences_;
+    std::vector<int> missedFrames_;
+    std::vector<int> ids_;
+
+    // Per-frame working memory
+    std::vector<float> cost_;            // detections x tracks
+    std::vector<int> parent_;            // union-find over tracks then detections
+    std::vector<int> rowStart_, colStart_;  // per root node: its cluster's slice of the lists below
+    std::vector<int> rowFill_, colFill_;
+    std::vector<int> componentRows_;     // track indices grouped by cluster
+    std::vector<int> componentCols_;     // detection indices grouped by cluster
+    std::vector<float> subCost_;
+    std::vector<int> subMatch_;
+    std::vector<int> trackMatch_;        // detection index per track, or -1
+    std::vector<char> detectionMatched_;
+    LinearAssignment solver_;
+};
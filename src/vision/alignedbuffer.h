@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+// Fixed-capacity heap buffer with cache-line (or wider) alignment.
+// Used for tensors that are bound to ONNX Runtime once and reused every frame.
+template <typename T, size_t Alignment = 64>
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t count) { reserve(count); }
+    ~AlignedBuffer() { release(); }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    // Ensures room for count elements. Returns true if memory was (re)allocated;
+    // existing contents are not preserved in that case.
+    bool reserve(size_t count) {
+        if (count <= size_) return false;
+        release();
+        data_ = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        size_ = count;
+        return true;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    void release() {
+        if (data_) {
+            ::operator delete(data_, std::align_val_t(Alignment));
+            data_ = nullptr;
+        }
+        size_ = 0;
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
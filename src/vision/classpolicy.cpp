@@ -0,0 +1,206 @@
+#include "classpolicy.h"
+#include "coco_labels.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+// Defaults reproduce the thresholds, area limits, NMS thresholds and colors
+// that used to live in the detect()/drawDetections() ladders
+static constexpr ClassPolicy makeDefaultPolicy(int c) {
+    ClassPolicy p{0.25f, 0.0005f, 0.95f, 0.4f, {0, 255, 0}};
+
+    // Confidence
+    if (c == 0) p.confThreshold = 0.5f;                                   // person
+    else if (c == 56 || c == 57) p.confThreshold = 0.2f;                  // chair, couch
+    else if (c == 59 || c == 60) p.confThreshold = 0.25f;                 // bed, dining table
+    else if (c >= 61 && c <= 63) p.confThreshold = 0.2f;                  // toilet, tv, laptop
+    else if (c == 64 || c == 65) p.confThreshold = 0.25f;                 // mouse, remote
+    else if (c == 66) p.confThreshold = 0.2f;                             // keyboard
+    else if (c == 67 || c == 68) p.confThreshold = 0.25f;                 // cell phone, microwave
+    else if (c == 73 || c == 74) p.confThreshold = 0.2f;                  // book, clock
+    else if (c >= 1 && c <= 9) p.confThreshold = 0.3f;                    // vehicles
+    else if (c >= 14 && c <= 23) p.confThreshold = 0.3f;                  // animals
+
+    // Area ratio
+    if (c == 0) {                                                         // person
+        p.minAreaRatio = 0.01f;
+        p.maxAreaRatio = 0.8f;
+    } else if (c == 64 || c == 66 || c == 67) {                           // small objects
+        p.minAreaRatio = 0.0001f;
+    } else if (c == 56 || c == 57 || c == 59) {                           // furniture
+        p.minAreaRatio = 0.005f;
+        p.maxAreaRatio = 0.9f;
+    }
+
+    // NMS
+    if (c == 0) p.nmsThreshold = 0.3f;                                    // person
+    else if (c >= 56 && c <= 60) p.nmsThreshold = 0.5f;                   // furniture
+    else if (c >= 61 && c <= 67) p.nmsThreshold = 0.6f;                   // electronics
+
+    // Color (BGR)
+    if (c == 0) { p.color[0] = 255; p.color[1] = 0; p.color[2] = 0; }                            // blue
+    else if (c == 2 || c == 5 || c == 7) { p.color[0] = 0; p.color[1] = 0; p.color[2] = 255; }   // red: vehicles
+    else if (c == 56 || c == 57 || c == 60) { p.color[0] = 0; p.color[1] = 165; p.color[2] = 255; } // orange: furniture
+    else if (c == 62 || c == 63 || c == 67) { p.color[0] = 255; p.color[1] = 255; p.color[2] = 0; } // cyan: electronics
+    else if (c == 39 || c == 41 || c == 45) { p.color[0] = 255; p.color[1] = 0; p.color[2] = 255; } // magenta: containers
+    else if (c >= 73 && c <= 75) { p.color[0] = 128; p.color[1] = 0; p.color[2] = 128; }          // purple: decorative
+    return p;
+}
+
+static constexpr std::array<ClassPolicy, ClassPolicyTable::NUM_CLASSES + 1> makeDefaultPolicies() {
+    std::array<ClassPolicy, ClassPolicyTable::NUM_CLASSES + 1> table{};
+    for (int c = 0; c <= ClassPolicyTable::NUM_CLASSES; c++) table[c] = makeDefaultPolicy(c);
+    return table;
+}
+
+static constexpr auto DEFAULT_POLICIES = makeDefaultPolicies();
+
+ClassPolicyTable::ClassPolicyTable() : policies_(DEFAULT_POLICIES) {
+    refreshDerived();
+}
+
+// The old code gated on CONF_THRESH before the class threshold, so the
+// effective class threshold is the larger of the two
+void ClassPolicyTable::refreshDerived() {
+    minConfThreshold_ = std::numeric_limits<float>::infinity();
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        if (!filter_.allows(c)) {
+            confThresholds_[c] = std::numeric_limits<float>::infinity();
+            continue;
+        }
+        confThresholds_[c] = std::max(scoreFloor_, policies_[c].confThreshold);
+        minConfThreshold_ = std::min(minConfThreshold_, confThresholds_[c]);
+    }
+}
+
+void ClassPolicyTable::setClassFilter(const ClassFilter& filter) {
+    filter_ = filter;
+    refreshDerived();
+}
+
+// A class given by id or by name; -1 if it is neither (out-of-range digit
+// strings included)
+static int classIdFromToken(const std::string& token) {
+    if (token.empty() || !std::all_of(token.begin(), token.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+        return ClassPolicyTable::classIdFromName(token);
+    }
+    try {
+        return std::stoi(token);
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+bool ClassFilter::parse(const std::string& list) {
+    std::vector<int> ids;
+    std::istringstream entries(list);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        if (entry.empty()) continue;
+        int classId = classIdFromToken(entry);
+        if (classId < 0 || classId >= NUM_CLASSES) {
+            std::cerr << "Unknown class '" << entry << "' in class list" << std::endl;
+            return false;
+        }
+        ids.push_back(classId);
+    }
+    set(ids);
+    return true;
+}
+
+void ClassFilter::set(const std::vector<int>& classIds) {
+    allowed_.fill(false);
+    ids_.clear();
+    for (int classId : classIds) {
+        if (classId >= 0 && classId < NUM_CLASSES) allowed_[classId] = true;
+    }
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        if (allowed_[c]) ids_.push_back(c);
+    }
+}
+
+int ClassPolicyTable::classIdFromName(const std::string& name) {
+    std::string spaced = name;
+    std::replace(spaced.begin(), spaced.end(), '_', ' ');
+    for (int c = 0; c < NUM_COCO_CLASSES; c++) {
+        if (spaced == COCO_CLASSES[c]) return c;
+    }
+    return -1;
+}
+
+bool ClassPolicyTable::loadOverrides(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open class policy file: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNo = 0;
+    int applied = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string first;
+        if (!(tokens >> first)) continue;
+
+        if (first.rfind("floor=", 0) == 0) {
+            try {
+                scoreFloor_ = std::stof(first.substr(6));
+                applied++;
+            } catch (const std::exception&) {
+                std::cerr << path << ":" << lineNo << ": bad value for 'floor'" << std::endl;
+            }
+            continue;
+        }
+        if (first.rfind("classes=", 0) == 0) {
+            if (!filter_.parse(first.substr(8))) {
+                std::cerr << path << ":" << lineNo << ": class list ignored" << std::endl;
+            }
+            applied++;
+            continue;
+        }
+
+        int classId = classIdFromToken(first);
+        if (classId < 0 || classId >= NUM_CLASSES) {
+            std::cerr << path << ":" << lineNo << ": unknown class '" << first << "'" << std::endl;
+            continue;
+        }
+
+        ClassPolicy& p = policies_[classId];
+        std::string kv;
+        while (tokens >> kv) {
+            size_t eq = kv.find('=');
+            if (eq == std::string::npos) continue;
+            std::string key = kv.substr(0, eq);
+            std::string value = kv.substr(eq + 1);
+            try {
+                if (key == "conf") p.confThreshold = std::stof(value);
+                else if (key == "min_area") p.minAreaRatio = std::stof(value);
+                else if (key == "max_area") p.maxAreaRatio = std::stof(value);
+                else if (key == "nms") p.nmsThreshold = std::stof(value);
+                else if (key == "color") {
+                    int b = 0, g = 0, r = 0;
+                    char sep1 = 0, sep2 = 0;
+                    std::istringstream(value) >> b >> sep1 >> g >> sep2 >> r;
+                    p.color[0] = static_cast<uint8_t>(std::clamp(b, 0, 255));
+                    p.color[1] = static_cast<uint8_t>(std::clamp(g, 0, 255));
+                    p.color[2] = static_cast<uint8_t>(std::clamp(r, 0, 255));
+                } else {
+                    std::cerr << path << ":" << lineNo << ": unknown key '" << key << "'" << std::endl;
+                }
+            } catch (const std::exception&) {
+                std::cerr << path << ":" << lineNo << ": bad value for '" << key << "'" << std::endl;
+            }
+        }
+        applied++;
+    }
+
+    refreshDerived();
+    std::cout << "Loaded " << applied << " class policy overrides from " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-class detection policy: everything the decoder, NMS and renderer need
+// to know about a COCO class, looked up by class id instead of if/else ladders
+// and label string compares.
+struct ClassPolicy {
+    float confThreshold;   // minimum score to keep a detection
+    float minAreaRatio;    // box area / frame area bounds
+    float maxAreaRatio;
+    float nmsThreshold;    // same-class IoU suppression threshold
+    uint8_t color[3];      // BGR draw color
+};
+
+// Allow-list of COCO classes shared by the decoder, tracker and LLM scene
+// context. Empty means every class is allowed.
+class ClassFilter {
+public:
+    static constexpr int NUM_CLASSES = 80;
+
+    // Comma-separated class names ('_' for spaces) or ids, e.g. "person,car,cell_phone".
+    // False (filter unchanged) if any entry is unknown.
+    bool parse(const std::string& list);
+    void set(const std::vector<int>& classIds);
+    void clear() { set({}); }
+
+    bool empty() const { return ids_.empty(); }
+    bool allows(int classId) const {
+        return ids_.empty() || (classId >= 0 && classId < NUM_CLASSES && allowed_[classId]);
+    }
+    // Allowed ids in ascending order (the decoder's class rows)
+    const std::vector<int>& ids() const { return ids_; }
+
+private:
+    std::vector<int> ids_;
+    std::array<bool, NUM_CLASSES> allowed_{};
+};
+
+class ClassPolicyTable {
+public:
+    static constexpr int NUM_CLASSES = 80;
+    static constexpr float DEFAULT_SCORE_FLOOR = 0.25f;  // global score gate before per-class checks
+
+    // Compiled-in defaults
+    ClassPolicyTable();
+
+    // Override entries from a text file, one class per line:
+    //   <class id|class name> [conf=F] [min_area=F] [max_area=F] [nms=F] [color=B,G,R]
+    //   floor=F            (global score floor)
+    //   classes=A,B,...    (class allow-list, see ClassFilter)
+    // '#' starts a comment; class names with spaces use '_' (dining_table).
+    bool loadOverrides(const std::string& path);
+
+    const ClassPolicy& operator[](int classId) const { return policies_[clampId(classId)]; }
+
+    // Contiguous per-class confidence thresholds for the decoder
+    const float* confThresholds() const { return confThresholds_.data(); }
+
+    // Scores at or below this never survive decoding
+    float scoreFloor() const { return scoreFloor_; }
+    // Lowest effective class threshold: the decoder's early-rejection cut
+    float minConfThreshold() const { return minConfThreshold_; }
+
+    // Classes outside the filter get an unreachable threshold and are left
+    // out of minConfThreshold()
+    void setClassFilter(const ClassFilter& filter);
+    const ClassFilter& classFilter() const { return filter_; }
+
+    static int classIdFromName(const std::string& name);
+
+private:
+    static int clampId(int classId) {
+        return (classId >= 0 && classId < NUM_CLASSES) ? classId : NUM_CLASSES;  // last slot: fallback
+    }
+    void refreshDerived();
+
+    std::array<ClassPolicy, NUM_CLASSES + 1> policies_;
+    std::array<float, NUM_CLASSES> confThresholds_;
+    float scoreFloor_ = DEFAULT_SCORE_FLOOR;
+    float minConfThreshold_ = DEFAULT_SCORE_FLOOR;
+    ClassFilter filter_;
+};
@@ -1,7 +1,8 @@
 #pragma once
 
 // COCO dataset class names (80 classes)
-const char* COCO_CLASSES[] = {
+inline constexpr int NUM_COCO_CLASSES = 80;
+inline constexpr const char* COCO_CLASSES[NUM_COCO_CLASSES] = {
     "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light",
     "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat", "dog", "horse", "sheep", "cow",
     "elephant", "bear", "zebra", "giraffe", "backpack", "umbrella", "handbag", "tie", "suitcase", "frisbee",
@@ -11,4 +12,9 @@ const char* COCO_CLASSES[] = {
     "potted plant", "bed", "dining table", "toilet", "tv", "laptop", "mouse", "remote", "keyboard", "cell phone",
     "microwave", "oven", "toaster", "sink", "refrigerator", "book", "clock", "vase", "scissors", "teddy bear",
     "hair drier", "toothbrush"
-};
\ No newline at end of file
+};
+
+// Label for a class id, resolved on demand (detections carry only the id)
+inline const char* cocoLabel(int classId) {
+    return (classId >= 0 && classId < NUM_COCO_CLASSES) ? COCO_CLASSES[classId] : "unknown";
+}
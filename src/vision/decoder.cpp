@@ -0,0 +1,222 @@
+#include "decoder.h"
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DECODER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DECODER_NEON 1
+#endif
+
+static inline void emit(const float* data, int64_t numPreds, int64_t i, float score, int classId,
+                        const float* classThresholds, std::vector<DecodedAnchor>& out) {
+    if (classThresholds && (classId < 0 || score <= classThresholds[classId])) return;
+    out.push_back({data[0 * numPreds + i], data[1 * numPreds + i],
+                   data[2 * numPreds + i], data[3 * numPreds + i],
+                   score, classId, static_cast<int>(i)});
+}
+
+// Per-anchor strided argmax over the class rows (the original detect() loop).
+// classIds, if given, lists the numClasses rows to visit.
+static void decodeRange(const float* data, const int* classIds, int numClasses, int64_t numPreds, int64_t begin,
+                        int64_t end, float minScore, const float* classThresholds,
+                        std::vector<DecodedAnchor>& out) {
+    const float* scores = data + 4 * numPreds;
+    for (int64_t i = begin; i < end; i++) {
+        float maxScore = 0;
+        int classId = -1;
+        for (int k = 0; k < numClasses; k++) {
+            int c = classIds ? classIds[k] : k;
+            float score = scores[c * numPreds + i];
+            if (score > maxScore) {
+                maxScore = score;
+                classId = c;
+            }
+        }
+        if (maxScore > minScore) {
+            emit(data, numPreds, i, maxScore, classId, classThresholds, out);
+        }
+    }
+}
+
+size_t YoloDecoder::decodeScalar(const float* data, int numClasses, int64_t numPreds,
+                                 float minScore, std::vector<DecodedAnchor>& out,
+                                 const float* classThresholds) {
+    size_t before = out.size();
+    decodeRange(data, nullptr, numClasses, numPreds, 0, numPreds, minScore, classThresholds, out);
+    return out.size() - before;
+}
+
+size_t YoloDecoder::decode(const float* data, int numClasses, int64_t numPreds,
+                           float minScore, std::vector<DecodedAnchor>& out,
+                           const float* classThresholds) {
+    return decodeRows(data, nullptr, numClasses, numPreds, minScore, out, classThresholds);
+}
+
+size_t YoloDecoder::decodeSubset(const float* data, const int* classIds, int classCount, int64_t numPreds,
+                                 float minScore, std::vector<DecodedAnchor>& out,
+                                 const float* classThresholds) {
+    return decodeRows(data, classIds, classCount, numPreds, minScore, out, classThresholds);
+}
+
+// Shared kernel: rows k = 0..numClasses-1 are class classIds[k] (or k)
+size_t YoloDecoder::decodeRows(const float* data, const int* classIds, int numClasses, int64_t numPreds,
+                               float minScore, std::vector<DecodedAnchor>& out,
+                               const float* classThresholds) {
+    size_t before = out.size();
+    if (numClasses <= 0) return 0;
+
+    const float* scores = data + 4 * numPreds;
+    const int firstClass = classIds ? classIds[0] : 0;
+    const float* firstRow = scores + firstClass * numPreds;
+    int64_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256 thresh = _mm256_set1_ps(minScore);
+    for (; i + 16 <= numPreds; i += 16) {
+        __m256 max0 = _mm256_loadu_ps(firstRow + i);
+        __m256 max1 = _mm256_loadu_ps(firstRow + i + 8);
+        __m256 idx0 = _mm256_set1_ps(static_cast<float>(firstClass));
+        __m256 idx1 = idx0;
+        for (int k = 1; k < numClasses; k++) {
+            int c = classIds ? classIds[k] : k;
+            const float* row = scores + c * numPreds + i;
+            __m256 v0 = _mm256_loadu_ps(row);
+            __m256 v1 = _mm256_loadu_ps(row + 8);
+            __m256 cv = _mm256_set1_ps(static_cast<float>(c));
+            __m256 gt0 = _mm256_cmp_ps(v0, max0, _CMP_GT_OQ);
+            __m256 gt1 = _mm256_cmp_ps(v1, max1, _CMP_GT_OQ);
+            max0 = _mm256_max_ps(max0, v0);
+            max1 = _mm256_max_ps(max1, v1);
+            idx0 = _mm256_blendv_ps(idx0, cv, gt0);
+            idx1 = _mm256_blendv_ps(idx1, cv, gt1);
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(max0, thresh, _CMP_GT_OQ))) |
+                        (static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(max1, thresh, _CMP_GT_OQ))) << 8);
+        if (!mask) continue;  // early rejection: no box math, no stores
+
+        alignas(32) float maxs[16];
+        alignas(32) float idxs[16];
+        _mm256_store_ps(maxs, max0);
+        _mm256_store_ps(maxs + 8, max1);
+        _mm256_store_ps(idxs, idx0);
+        _mm256_store_ps(idxs + 8, idx1);
+        while (mask) {
+            int j = __builtin_ctz(mask);
+            mask &= mask - 1;
+            emit(data, numPreds, i + j, maxs[j], static_cast<int>(idxs[j]), classThresholds, out);
+        }
+    }
+#elif defined(DECODER_SSE2) || defined(DECODER_NEON)
+    for (; i + 16 <= numPreds; i += 16) {
+#if defined(DECODER_SSE2)
+        __m128 maxv[4], idxv[4];
+        for (int k = 0; k < 4; k++) {
+            maxv[k] = _mm_loadu_ps(firstRow + i + 4 * k);
+            idxv[k] = _mm_set1_ps(static_cast<float>(firstClass));
+        }
+        for (int r = 1; r < numClasses; r++) {
+            int c = classIds ? classIds[r] : r;
+            const float* row = scores + c * numPreds + i;
+            __m128 cv = _mm_set1_ps(static_cast<float>(c));
+            for (int k = 0; k < 4; k++) {
+                __m128 v = _mm_loadu_ps(row + 4 * k);
+                __m128 gt = _mm_cmpgt_ps(v, maxv[k]);
+                maxv[k] = _mm_max_ps(maxv[k], v);
+                idxv[k] = _mm_or_ps(_mm_and_ps(gt, cv), _mm_andnot_ps(gt, idxv[k]));
+            }
+        }
+        const __m128 thresh = _mm_set1_ps(minScore);
+        unsigned mask = 0;
+        for (int k = 0; k < 4; k++) {
+            mask |= static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(maxv[k], thresh))) << (4 * k);
+        }
+        if (!mask) continue;
+
+        alignas(16) float maxs[16];
+        alignas(16) float idxs[16];
+        for (int k = 0; k < 4; k++) {
+            _mm_store_ps(maxs + 4 * k, maxv[k]);
+            _mm_store_ps(idxs + 4 * k, idxv[k]);
+        }
+#else
+        float32x4_t maxv[4];
+        uint32x4_t idxv[4];
+        for (int k = 0; k < 4; k++) {
+            maxv[k] = vld1q_f32(firstRow + i + 4 * k);
+            idxv[k] = vdupq_n_u32(static_cast<uint32_t>(firstClass));
+        }
+        for (int r = 1; r < numClasses; r++) {
+            int c = classIds ? classIds[r] : r;
+            const float* row = scores + c * numPreds + i;
+            uint32x4_t cv = vdupq_n_u32(static_cast<uint32_t>(c));
+            for (int k = 0; k < 4; k++) {
+                float32x4_t v = vld1q_f32(row + 4 * k);
+                uint32x4_t gt = vcgtq_f32(v, maxv[k]);
+                maxv[k] = vmaxq_f32(maxv[k], v);
+                idxv[k] = vbslq_u32(gt, cv, idxv[k]);
+            }
+        }
+        float maxs[16];
+        uint32_t idxu[16];
+        for (int k = 0; k < 4; k++) {
+            vst1q_f32(maxs + 4 * k, maxv[k]);
+            vst1q_u32(idxu + 4 * k, idxv[k]);
+        }
+        unsigned mask = 0;
+        for (int j = 0; j < 16; j++) {
+            if (maxs[j] > minScore) mask |= 1u << j;
+        }
+        if (!mask) continue;
+
+        float idxs[16];
+        for (int j = 0; j < 16; j++) idxs[j] = static_cast<float>(idxu[j]);
+#endif
+        while (mask) {
+            int j = __builtin_ctz(mask);
+            mask &= mask - 1;
+            emit(data, numPreds, i + j, maxs[j], static_cast<int>(idxs[j]), classThresholds, out);
+        }
+    }
+#endif
+
+    // Remainder (and builds without SIMD)
+    decodeRange(data, classIds, numClasses, numPreds, i, numPreds, minScore, classThresholds, out);
+    return out.size() - before;
+}
+
+OutputLayout detectOutputLayout(const std::vector<int64_t>& shape, const char* metadataHint) {
+    if (metadataHint) {
+        std::string hint(metadataHint);
+        if (hint == "end2end" || hint == "e2e") return OutputLayout::EndToEnd;
+        if (hint == "anchors") return OutputLayout::Anchors;
+    }
+    if (shape.size() == 3 && shape[2] == EndToEndDecoder::ROW_SIZE && shape[1] != EndToEndDecoder::ROW_SIZE) {
+        return OutputLayout::EndToEnd;
+    }
+    return OutputLayout::Anchors;
+}
+
+const char* outputLayoutName(OutputLayout layout) {
+    return layout == OutputLayout::EndToEnd ? "end-to-end" : "anchors";
+}
+
+size_t EndToEndDecoder::decode(const float* data, int64_t numDetections, int numClasses,
+                               float minScore, std::vector<DecodedAnchor>& out,
+                               const float* classThresholds) {
+    size_t before = out.size();
+    for (int64_t i = 0; i < numDetections; i++) {
+        const float* row = data + i * ROW_SIZE;
+        float score = row[4];
+        if (!(score > minScore)) continue;
+        int classId = static_cast<int>(row[5]);
+        if (classId < 0 || classId >= numClasses) continue;
+        if (classThresholds && score <= classThresholds[classId]) continue;
+        out.push_back({(row[0] + row[2]) * 0.5f, (row[1] + row[3]) * 0.5f,
+                       row[2] - row[0], row[3] - row[1], score, classId, static_cast<int>(i)});
+    }
+    return out.size() - before;
+}
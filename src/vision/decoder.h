@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Detection head output layouts. Anchors (YOLOv8): [N, 4 + classes, anchors]
+// of cx,cy,w,h plus per-class scores, needing argmax and NMS. EndToEnd
+// (YOLOv10): [N, maxDet, 6] of final x1,y1,x2,y2,score,class, already
+// de-duplicated by the network.
+enum class OutputLayout {
+    Anchors,
+    EndToEnd,
+};
+
+// Layout of a model output. The "output_layout" metadata value ("anchors" or
+// "end2end") wins when present; otherwise a trailing dimension of 6 (with a
+// middle dimension that is not) means end-to-end.
+OutputLayout detectOutputLayout(const std::vector<int64_t>& shape, const char* metadataHint = nullptr);
+const char* outputLayoutName(OutputLayout layout);
+
+// One anchor that survived the score test, in model (letterboxed) coordinates
+struct DecodedAnchor {
+    float cx, cy, w, h;
+    float score;
+    int classId;
+    int anchor;
+};
+
+// Vectorized decoder for the YOLOv8 [4 + numClasses, numPreds] output layout.
+// Class rows are contiguous across anchors, so 16 anchors are processed per
+// step: running max score and class index stay in registers while walking
+// the class rows, and anchors whose best score does not exceed minScore are
+// rejected before any box data is touched. Optional per-class thresholds
+// (indexed by class id) are applied to the survivors.
+class YoloDecoder {
+public:
+    // Appends survivors to out (not cleared). Returns the number appended.
+    static size_t decode(const float* data, int numClasses, int64_t numPreds,
+                         float minScore, std::vector<DecodedAnchor>& out,
+                         const float* classThresholds = nullptr);
+
+    // Argmax over only the listed class rows (ascending ids), so the cost
+    // scales with classCount instead of the model's class count. Scores of
+    // other classes are never read.
+    static size_t decodeSubset(const float* data, const int* classIds, int classCount, int64_t numPreds,
+                               float minScore, std::vector<DecodedAnchor>& out,
+                               const float* classThresholds = nullptr);
+
+    // Scalar reference with identical results, used for verification/benchmarks
+    static size_t decodeScalar(const float* data, int numClasses, int64_t numPreds,
+                               float minScore, std::vector<DecodedAnchor>& out,
+                               const float* classThresholds = nullptr);
+
+private:
+    static size_t decodeRows(const float* data, const int* classIds, int numClasses, int64_t numPreds,
+                             float minScore, std::vector<DecodedAnchor>& out, const float* classThresholds);
+};
+
+// Decoder for end-to-end [numDetections, 6] rows. Rows are converted to the
+// same DecodedAnchor form (centre/size, model coordinates) and filtered by
+// the same thresholds as YoloDecoder, so both layouts share the class-policy
+// path downstream. anchor holds the row index.
+class EndToEndDecoder {
+public:
+    static constexpr int ROW_SIZE = 6;
+
+    // Appends survivors to out (not cleared). Returns the number appended.
+    static size_t decode(const float* data, int64_t numDetections, int numClasses,
+                         float minScore, std::vector<DecodedAnchor>& out,
+                         const float* classThresholds = nullptr);
+};
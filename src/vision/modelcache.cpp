@@ -0,0 +1,43 @@
+#include "modelcache.h"
+#include <onnxruntime/onnxruntime_cxx_api.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+bool hashFile(const std::string& path, uint64_t& hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    hash = FNV1A_OFFSET;
+    std::vector<char> chunk(1 << 16);
+    while (in) {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        hash = fnv1a(chunk.data(), static_cast<size_t>(in.gcount()), hash);
+    }
+    return true;
+}
+
+std::string optimizedModelPath(const std::string& cacheDir, const std::string& modelPath,
+                               const std::string& optionsKey) {
+    uint64_t hash = 0;
+    if (!hashFile(modelPath, hash)) return std::string();
+    std::string version = Ort::GetVersionString();
+    hash = fnv1a(version.data(), version.size(), hash);
+    hash = fnv1a(optionsKey.data(), optionsKey.size(), hash);
+
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+    std::string stem = std::filesystem::path(modelPath).stem().string();
+    return (std::filesystem::path(cacheDir) / (stem + "." + key + ".onnx")).string();
+}
+
+double readColdStartMs(const std::string& cachePath) {
+    std::ifstream in(cachePath + ".cold_ms");
+    double ms = 0.0;
+    return (in >> ms) ? ms : 0.0;
+}
+
+void writeColdStartMs(const std::string& cachePath, double ms) {
+    std::ofstream out(cachePath + ".cold_ms");
+    out << ms << std::endl;
+}
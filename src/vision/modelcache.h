@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// On-disk cache of ONNX Runtime optimized models.
+//
+// ORT can serialize the graph it produced after optimization; loading that
+// file with optimizations disabled skips the (slow) optimization passes on
+// later starts. The cache file name is keyed by everything that changes the
+// optimized graph: the model bytes, the ORT version and the graph-affecting
+// session options, so a stale entry is never picked up.
+
+inline constexpr uint64_t FNV1A_OFFSET = 0xcbf29ce484222325ull;
+inline constexpr uint64_t FNV1A_PRIME = 0x100000001b3ull;
+
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV1A_OFFSET) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+// FNV-1a of a whole file. Returns false if it cannot be read.
+bool hashFile(const std::string& path, uint64_t& hash);
+
+// <cacheDir>/<model stem>.<key>.onnx for this model and options key, or an
+// empty string if the model cannot be read
+std::string optimizedModelPath(const std::string& cacheDir, const std::string& modelPath,
+                               const std::string& optionsKey);
+
+// Cold-start session creation time stored next to a cache entry, 0 if unknown
+double readColdStartMs(const std::string& cachePath);
+void writeColdStartMs(const std::string& cachePath, double ms);
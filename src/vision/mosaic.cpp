@@ -0,0 +1,38 @@
+#include "mosaic.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int MOSAIC_GUTTER = 8;  // keeps a box from spanning two tiles
+
+bool packMosaic(const std::vector<cv::Rect>& regions, const cv::Size& frameSize, float scale,
+                int canvasSize, std::vector<MosaicTile>& tiles) {
+    tiles.clear();
+    const cv::Rect frameRect(0, 0, frameSize.width, frameSize.height);
+    for (const cv::Rect& region : regions) {
+        cv::Rect source = region & frameRect;
+        if (source.width <= 0 || source.height <= 0) continue;
+        int width = std::max(1, static_cast<int>(std::lround(source.width * scale)));
+        int height = std::max(1, static_cast<int>(std::lround(source.height * scale)));
+        if (width > canvasSize || height > canvasSize) return false;
+        tiles.push_back({source, cv::Rect(0, 0, width, height)});
+    }
+
+    // Tallest first, left to right in shelves
+    std::sort(tiles.begin(), tiles.end(), [](const MosaicTile& a, const MosaicTile& b) {
+        return a.canvas.height > b.canvas.height;
+    });
+    int x = 0, y = 0, shelfHeight = 0;
+    for (MosaicTile& tile : tiles) {
+        if (x + tile.canvas.width > canvasSize) {
+            x = 0;
+            y += shelfHeight + MOSAIC_GUTTER;
+            shelfHeight = 0;
+        }
+        if (y + tile.canvas.height > canvasSize) return false;
+        tile.canvas.x = x;
+        tile.canvas.y = y;
+        x += tile.canvas.width + MOSAIC_GUTTER;
+        shelfHeight = std::max(shelfHeight, tile.canvas.height);
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// One frame region placed on the mosaic canvas
+struct MosaicTile {
+    cv::Rect source;  // frame pixels
+    cv::Rect canvas;  // where they land on the canvas (scaled)
+
+    // Canvas point → frame point
+    cv::Point2f toFrame(float x, float y) const {
+        return cv::Point2f(source.x + (x - canvas.x) * source.width / canvas.width,
+                           source.y + (y - canvas.y) * source.height / canvas.height);
+    }
+};
+
+// Shelf-packs frame regions, each scaled by scale, into a canvasSize square
+// with a grey gutter between tiles. Regions are clipped to the frame. Returns
+// false (tiles unspecified) if they do not fit.
+bool packMosaic(const std::vector<cv::Rect>& regions, const cv::Size& frameSize, float scale,
+                int canvasSize, std::vector<MosaicTile>& tiles);
@@ -0,0 +1,39 @@
+#include "motiongate.h"
+#include <algorithm>
+
+MotionGate::MotionGate(const MotionGateConfig& config) : config_(config) {}
+
+bool MotionGate::shouldInfer(const cv::Mat& frame, std::chrono::steady_clock::time_point now) {
+    stats_.frames++;
+
+    // Area-averaged thumbnail: also suppresses sensor noise
+    int width = std::min(config_.thumbnailWidth, frame.cols);
+    int height = std::max(1, frame.rows * width / std::max(1, frame.cols));
+    cv::resize(frame, thumbnail_, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (thumbnail_.channels() == 3) cv::cvtColor(thumbnail_, grey_, cv::COLOR_BGR2GRAY);
+    else grey_ = thumbnail_;
+
+    bool infer = false;
+    if (reference_.empty() || reference_.size() != grey_.size()) {
+        infer = true;
+        lastChangedFraction_ = 1.0f;
+    } else {
+        cv::absdiff(grey_, reference_, diff_);
+        cv::threshold(diff_, diff_, config_.pixelThreshold, 255, cv::THRESH_BINARY);
+        lastChangedFraction_ = static_cast<float>(cv::countNonZero(diff_)) / static_cast<float>(diff_.total());
+        if (lastChangedFraction_ > config_.changedFraction) {
+            infer = true;
+            stats_.motionTriggers++;
+        } else if (now - lastInference_ >= config_.maxStaleness) {
+            infer = true;
+            stats_.staleTriggers++;
+        }
+    }
+
+    if (infer) {
+        grey_.copyTo(reference_);
+        lastInference_ = now;
+        stats_.inferences++;
+    }
+    return infer;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+
+struct MotionGateConfig {
+    int thumbnailWidth = 160;          // frames are compared at this width (aspect kept)
+    int pixelThreshold = 15;           // grey-level change that counts a pixel as changed
+    float changedFraction = 0.004f;    // fraction of changed pixels that counts as motion
+    std::chrono::milliseconds maxStaleness{1000};  // force inference at least this often
+};
+
+struct MotionGateStats {
+    uint64_t frames = 0;
+    uint64_t inferences = 0;     // frames the detector ran on
+    uint64_t motionTriggers = 0; // ... because the scene changed
+    uint64_t staleTriggers = 0;  // ... because the last result was too old
+};
+
+// Cheap scene-change test in front of VisionModule::detect. Each frame is
+// shrunk to a small grey thumbnail and diffed against the thumbnail of the
+// last frame inference ran on (not the previous frame, so slow drift still
+// accumulates into motion). Static scenes reuse the previous result until
+// maxStaleness expires.
+class MotionGate {
+public:
+    explicit MotionGate(const MotionGateConfig& config = MotionGateConfig());
+
+    // True if the detector should run on this frame. Updates the reference
+    // thumbnail when it returns true.
+    bool shouldInfer(const cv::Mat& frame,
+                     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // Forget the reference so the next frame is always inferred
+    void reset() { reference_.release(); }
+
+    const MotionGateConfig& config() const { return config_; }
+    const MotionGateStats& stats() const { return stats_; }
+    // Fraction of changed pixels in the last tested frame
+    float lastChangedFraction() const { return lastChangedFraction_; }
+
+private:
+    MotionGateConfig config_;
+    MotionGateStats stats_;
+    cv::Mat thumbnail_;
+    cv::Mat grey_;
+    cv::Mat reference_;
+    cv::Mat diff_;
+    std::chrono::steady_clock::time_point lastInference_;
+    float lastChangedFraction_ = 0.0f;
+};
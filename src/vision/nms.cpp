@@ -0,0 +1,310 @@
+#include "nms.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(__AVX2__) || defined(__AVX__)
+#include <immintrin.h>
+#define NMS_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NMS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NMS_NEON 1
+#endif
+
+// IoU of box a against n SoA boxes. Bit-identical to the cv::Rect version for
+// integer coordinates: intersection and union are exact in float.
+static void iouBatch(float ax1, float ay1, float ax2, float ay2, float aArea,
+                     const float* x1, const float* y1, const float* x2, const float* y2,
+                     const float* area, int n, float* out) {
+    int i = 0;
+#if defined(NMS_AVX)
+    const __m256 vax1 = _mm256_set1_ps(ax1), vay1 = _mm256_set1_ps(ay1);
+    const __m256 vax2 = _mm256_set1_ps(ax2), vay2 = _mm256_set1_ps(ay2);
+    const __m256 varea = _mm256_set1_ps(aArea);
+    const __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256 w = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vax2, _mm256_loadu_ps(x2 + i)),
+                                                     _mm256_max_ps(vax1, _mm256_loadu_ps(x1 + i))));
+        __m256 h = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vay2, _mm256_loadu_ps(y2 + i)),
+                                                     _mm256_max_ps(vay1, _mm256_loadu_ps(y1 + i))));
+        __m256 inter = _mm256_mul_ps(w, h);
+        __m256 uni = _mm256_sub_ps(_mm256_add_ps(varea, _mm256_loadu_ps(area + i)), inter);
+        __m256 valid = _mm256_cmp_ps(uni, zero, _CMP_GT_OQ);
+        _mm256_storeu_ps(out + i, _mm256_and_ps(valid, _mm256_div_ps(inter, uni)));
+    }
+#elif defined(NMS_SSE2)
+    const __m128 vax1 = _mm_set1_ps(ax1), vay1 = _mm_set1_ps(ay1);
+    const __m128 vax2 = _mm_set1_ps(ax2), vay2 = _mm_set1_ps(ay2);
+    const __m128 varea = _mm_set1_ps(aArea);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 w = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(vax2, _mm_loadu_ps(x2 + i)),
+                                               _mm_max_ps(vax1, _mm_loadu_ps(x1 + i))));
+        __m128 h = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(vay2, _mm_loadu_ps(y2 + i)),
+                                               _mm_max_ps(vay1, _mm_loadu_ps(y1 + i))));
+        __m128 inter = _mm_mul_ps(w, h);
+        __m128 uni = _mm_sub_ps(_mm_add_ps(varea, _mm_loadu_ps(area + i)), inter);
+        __m128 valid = _mm_cmpgt_ps(uni, zero);
+        _mm_storeu_ps(out + i, _mm_and_ps(valid, _mm_div_ps(inter, uni)));
+    }
+#elif defined(NMS_NEON)
+    const float32x4_t vax1 = vdupq_n_f32(ax1), vay1 = vdupq_n_f32(ay1);
+    const float32x4_t vax2 = vdupq_n_f32(ax2), vay2 = vdupq_n_f32(ay2);
+    const float32x4_t varea = vdupq_n_f32(aArea);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t w = vmaxq_f32(zero, vsubq_f32(vminq_f32(vax2, vld1q_f32(x2 + i)),
+                                                  vmaxq_f32(vax1, vld1q_f32(x1 + i))));
+        float32x4_t h = vmaxq_f32(zero, vsubq_f32(vminq_f32(vay2, vld1q_f32(y2 + i)),
+                                                  vmaxq_f32(vay1, vld1q_f32(y1 + i))));
+        float32x4_t inter = vmulq_f32(w, h);
+        float32x4_t uni = vsubq_f32(vaddq_f32(varea, vld1q_f32(area + i)), inter);
+        uint32x4_t valid = vcgtq_f32(uni, zero);
+        float32x4_t iou = vdivq_f32(inter, vbslq_f32(valid, uni, vdupq_n_f32(1.0f)));
+        vst1q_f32(out + i, vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(iou))));
+    }
+#endif
+    for (; i < n; i++) {
+        float w = std::max(0.0f, std::min(ax2, x2[i]) - std::max(ax1, x1[i]));
+        float h = std::max(0.0f, std::min(ay2, y2[i]) - std::max(ay1, y1[i]));
+        float inter = w * h;
+        float uni = aArea + area[i] - inter;
+        out[i] = (uni > 0) ? inter / uni : 0.0f;
+    }
+}
+
+NmsEngine::NmsEngine() {
+    for (int c = 0; c < MAX_CLASSES; c++) classThreshold_[c] = DEFAULT_NMS_THRESH;
+}
+
+void NmsEngine::setClassThreshold(int classId, float threshold) {
+    if (classId >= 0 && classId < MAX_CLASSES) classThreshold_[classId] = threshold;
+}
+
+float NmsEngine::classThreshold(int classId) const {
+    return (classId >= 0 && classId < MAX_CLASSES) ? classThreshold_[classId] : DEFAULT_NMS_THRESH;
+}
+
+float NmsEngine::minThreshold() const {
+    return std::min(crossClassThreshold_, *std::min_element(classThreshold_, classThreshold_ + MAX_CLASSES));
+}
+
+void NmsEngine::clear() {
+    x1_.clear();
+    y1_.clear();
+    x2_.clear();
+    y2_.clear();
+    score_.clear();
+    cls_.clear();
+}
+
+void NmsEngine::reserve(size_t count) {
+    for (auto* v : {&x1_, &y1_, &x2_, &y2_, &score_, &sx1_, &sy1_, &sx2_, &sy2_, &sarea_,
+                    &gx1_, &gy1_, &gx2_, &gy2_, &garea_, &giou_}) {
+        v->reserve(count);
+    }
+    for (auto* v : {&cls_, &order_, &scls_, &keep_, &neighbours_}) {
+        v->reserve(count);
+    }
+    removed_.reserve(count);
+    scx_.reserve(count);
+    scy_.reserve(count);
+    byCell_.reserve(count);
+    byClassCell_.reserve(count);
+}
+
+void NmsEngine::add(float x, float y, float width, float height, float score, int classId) {
+    x1_.push_back(x);
+    y1_.push_back(y);
+    x2_.push_back(x + width);
+    y2_.push_back(y + height);
+    score_.push_back(score);
+    cls_.push_back(classId);
+}
+
+void NmsEngine::sortByScore() {
+    const size_t n = score_.size();
+    order_.resize(n);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(order_.begin(), order_.end(),
+                     [this](int a, int b) { return score_[a] > score_[b]; });
+
+    sx1_.resize(n);
+    sy1_.resize(n);
+    sx2_.resize(n);
+    sy2_.resize(n);
+    sarea_.resize(n);
+    scls_.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        int src = order_[k];
+        sx1_[k] = x1_[src];
+        sy1_[k] = y1_[src];
+        sx2_[k] = x2_[src];
+        sy2_[k] = y2_[src];
+        sarea_[k] = (x2_[src] - x1_[src]) * (y2_[src] - y1_[src]);
+        scls_[k] = cls_[src];
+    }
+}
+
+// Applies box i's thresholds to the IoU values already in giou_
+void NmsEngine::suppressAgainst(int i, const int* neighbours, int count) {
+    const int cls = scls_[i];
+    // A same-class pair below the class threshold is still caught by the
+    // cross-class rule, exactly as in the original if/else
+    const float sameThreshold = std::min(classThreshold(cls), crossClassThreshold_);
+    for (int k = 0; k < count; k++) {
+        int j = neighbours ? neighbours[k] : i + 1 + k;
+        float threshold = (scls_[j] == cls) ? sameThreshold : crossClassThreshold_;
+        if (giou_[k] > threshold) removed_[j] = 1;
+    }
+}
+
+void NmsEngine::sweepAllPairs() {
+    const int n = static_cast<int>(sx1_.size());
+    giou_.resize(n);
+    for (int i = 0; i < n; i++) {
+        if (removed_[i]) continue;
+        keep_.push_back(order_[i]);
+
+        // IoU against the contiguous tail [i+1, n) in one SIMD pass
+        int count = n - i - 1;
+        iouBatch(sx1_[i], sy1_[i], sx2_[i], sy2_[i], sarea_[i],
+                 sx1_.data() + i + 1, sy1_.data() + i + 1, sx2_.data() + i + 1,
+                 sy2_.data() + i + 1, sarea_.data() + i + 1, count, giou_.data());
+        suppressAgainst(i, nullptr, count);
+    }
+}
+
+// Half-width of the centre window that can contain a box with IoU > t against a
+// box of width w: IoU > t implies overlap > t * max(wi, wj) and wj < wi / t, so
+// |dcx| < w * max(1 - t, 0.5 / t - 0.5). The same bound holds for heights.
+// Only called with t >= GRID_MIN_THRESHOLD.
+static float searchRadius(float t) {
+    return std::max(1.0f - t, 0.5f / t - 0.5f);
+}
+
+void NmsEngine::sweepGrid() {
+    const int n = static_cast<int>(sx1_.size());
+
+    // Uniform grid over box centres, cell size half the typical box side
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    double sideSum = 0;
+    scx_.resize(n);
+    scy_.resize(n);
+    for (int i = 0; i < n; i++) {
+        scx_[i] = 0.5f * (sx1_[i] + sx2_[i]);
+        scy_[i] = 0.5f * (sy1_[i] + sy2_[i]);
+        minX = (i == 0) ? scx_[i] : std::min(minX, scx_[i]);
+        minY = (i == 0) ? scy_[i] : std::min(minY, scy_[i]);
+        maxX = (i == 0) ? scx_[i] : std::max(maxX, scx_[i]);
+        maxY = (i == 0) ? scy_[i] : std::max(maxY, scy_[i]);
+        sideSum += std::max(sx2_[i] - sx1_[i], sy2_[i] - sy1_[i]);
+    }
+    float cell = std::max(8.0f, static_cast<float>(0.5 * sideSum / n));
+    int gw = static_cast<int>((maxX - minX) / cell) + 1;
+    int gh = static_cast<int>((maxY - minY) / cell) + 1;
+    while (gw * gh > 16384) {
+        cell *= 2.0f;
+        gw = static_cast<int>((maxX - minX) / cell) + 1;
+        gh = static_cast<int>((maxY - minY) / cell) + 1;
+    }
+    const uint32_t cells = static_cast<uint32_t>(gw) * gh;
+    const float invCell = 1.0f / cell;
+
+    // Two sorted indexes: by cell (cross-class queries) and by (class, cell)
+    // (same-class queries). A window row is then one contiguous key range.
+    byCell_.resize(n);
+    byClassCell_.resize(n);
+    for (int i = 0; i < n; i++) {
+        int cx = std::min(gw - 1, static_cast<int>((scx_[i] - minX) * invCell));
+        int cy = std::min(gh - 1, static_cast<int>((scy_[i] - minY) * invCell));
+        uint32_t c = static_cast<uint32_t>(cy * gw + cx);
+        uint32_t cls = static_cast<uint32_t>(std::min(std::max(scls_[i], 0), MAX_CLASSES - 1));
+        byCell_[i] = {c, i};
+        byClassCell_[i] = {cls * cells + c, i};
+    }
+    auto byKey = [](const KeyedIndex& a, const KeyedIndex& b) {
+        return a.key < b.key || (a.key == b.key && a.index < b.index);
+    };
+    std::sort(byCell_.begin(), byCell_.end(), byKey);
+    std::sort(byClassCell_.begin(), byClassCell_.end(), byKey);
+
+    const float crossRadius = searchRadius(crossClassThreshold_);
+
+    // Greedy sweep; only boxes whose centres fall inside the window are compared
+    for (int i = 0; i < n; i++) {
+        if (removed_[i]) continue;
+        keep_.push_back(order_[i]);
+
+        const int cls = scls_[i];
+        const float w = sx2_[i] - sx1_[i];
+        const float h = sy2_[i] - sy1_[i];
+        neighbours_.clear();
+
+        auto scan = [&](const std::vector<KeyedIndex>& index, uint32_t base, float radius, bool sameClass) {
+            float rx = radius * w + 1.0f;
+            float ry = radius * h + 1.0f;
+            int cx0 = std::max(0, static_cast<int>((scx_[i] - rx - minX) * invCell));
+            int cy0 = std::max(0, static_cast<int>((scy_[i] - ry - minY) * invCell));
+            int cx1 = std::min(gw - 1, static_cast<int>((scx_[i] + rx - minX) * invCell));
+            int cy1 = std::min(gh - 1, static_cast<int>((scy_[i] + ry - minY) * invCell));
+            for (int cy = cy0; cy <= cy1; cy++) {
+                uint32_t lo = base + static_cast<uint32_t>(cy * gw + cx0);
+                uint32_t hi = base + static_cast<uint32_t>(cy * gw + cx1);
+                auto it = std::lower_bound(index.begin(), index.end(), lo,
+                                           [](const KeyedIndex& k, uint32_t key) { return k.key < key; });
+                for (; it != index.end() && it->key <= hi; ++it) {
+                    int j = it->index;
+                    if (j <= i || removed_[j]) continue;
+                    if ((scls_[j] == cls) != sameClass) continue;
+                    neighbours_.push_back(j);
+                }
+            }
+        };
+
+        // Same-class window uses the (lower) effective class threshold, which
+        // always covers the cross-class window, so each pair is visited once
+        float sameThreshold = std::min(classThreshold(cls), crossClassThreshold_);
+        uint32_t clsBase = static_cast<uint32_t>(std::min(std::max(cls, 0), MAX_CLASSES - 1)) * cells;
+        scan(byClassCell_, clsBase, searchRadius(sameThreshold), true);
+        scan(byCell_, 0, crossRadius, false);
+        if (neighbours_.empty()) continue;
+
+        // Gather neighbours into contiguous SoA scratch for the SIMD IoU kernel
+        int count = static_cast<int>(neighbours_.size());
+        gx1_.resize(count);
+        gy1_.resize(count);
+        gx2_.resize(count);
+        gy2_.resize(count);
+        garea_.resize(count);
+        giou_.resize(count);
+        for (int k = 0; k < count; k++) {
+            int j = neighbours_[k];
+            gx1_[k] = sx1_[j];
+            gy1_[k] = sy1_[j];
+            gx2_[k] = sx2_[j];
+            gy2_[k] = sy2_[j];
+            garea_[k] = sarea_[j];
+        }
+        iouBatch(sx1_[i], sy1_[i], sx2_[i], sy2_[i], sarea_[i], gx1_.data(), gy1_.data(),
+                 gx2_.data(), gy2_.data(), garea_.data(), count, giou_.data());
+        suppressAgainst(i, neighbours_.data(), count);
+    }
+}
+
+const std::vector<int>& NmsEngine::run() {
+    keep_.clear();
+    if (score_.empty()) return keep_;
+
+    sortByScore();
+    removed_.assign(score_.size(), 0);
+    if (score_.size() < GRID_MIN_BOXES || minThreshold() < GRID_MIN_THRESHOLD) {
+        sweepAllPairs();
+    } else {
+        sweepGrid();
+    }
+    return keep_;
+}
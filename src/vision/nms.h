@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Class-aware greedy non-maximum suppression.
+//
+// Same thresholds and suppression rule as the original detect(): candidates
+// are visited in descending score order and a kept box suppresses every later
+// box whose IoU exceeds the kept box's class threshold (same class) or the
+// cross-class threshold (different class). Tie order is stable (add() order),
+// where the original's std::sort left it unspecified. Boxes are stored as
+// structure-of-arrays; small sets are compared with a SIMD IoU kernel over
+// contiguous ranges. Larger sets are indexed by box centre on a uniform grid,
+// bucketed per class: a kept box only looks at same-class boxes inside a
+// window derived from its class threshold and at other-class boxes inside the
+// (much smaller) cross-class window, since no box outside those windows can
+// exceed the IoU threshold.
+class NmsEngine {
+public:
+    static constexpr int MAX_CLASSES = 80;
+    static constexpr float DEFAULT_NMS_THRESH = 0.4f;
+    static constexpr float CROSS_CLASS_THRESH = 0.8f;
+
+    NmsEngine();
+
+    void clear();
+    void reserve(size_t count);
+    void add(float x, float y, float width, float height, float score, int classId);
+    size_t size() const { return score_.size(); }
+
+    // Same-class IoU threshold, normally taken from the ClassPolicyTable
+    void setClassThreshold(int classId, float threshold);
+    float classThreshold(int classId) const;
+    void setCrossClassThreshold(float threshold) { crossClassThreshold_ = threshold; }
+
+    // Indices (in add() order) of the kept boxes, highest score first
+    const std::vector<int>& run();
+
+    // Candidate count above which the spatial grid replaces the all-pairs sweep
+    static constexpr size_t GRID_MIN_BOXES = 128;
+    // Lowest IoU threshold the grid handles; below it the search window grows
+    // towards the whole frame, so any lower threshold sweeps all pairs
+    static constexpr float GRID_MIN_THRESHOLD = 0.05f;
+
+private:
+    void sortByScore();
+    void sweepAllPairs();
+    void sweepGrid();
+    void suppressAgainst(int i, const int* neighbours, int count);
+    float minThreshold() const;
+
+    float classThreshold_[MAX_CLASSES];
+    float crossClassThreshold_ = CROSS_CLASS_THRESH;
+
+    // Input, in add() order
+    std::vector<float> x1_, y1_, x2_, y2_, score_;
+    std::vector<int> cls_;
+
+    // Working set, in descending score order
+    std::vector<int> order_;
+    std::vector<float> sx1_, sy1_, sx2_, sy2_, sarea_;
+    std::vector<int> scls_;
+    std::vector<uint8_t> removed_;
+    std::vector<int> keep_;
+
+    // Scratch for gathered neighbours and their IoU with the current box
+    std::vector<float> gx1_, gy1_, gx2_, gy2_, garea_, giou_;
+    std::vector<int> neighbours_;
+
+    // Centre grid: box indices sorted by cell and by (class, cell)
+    struct KeyedIndex {
+        uint32_t key;
+        int index;
+    };
+    std::vector<float> scx_, scy_;
+    std::vector<KeyedIndex> byCell_;
+    std::vector<KeyedIndex> byClassCell_;
+};
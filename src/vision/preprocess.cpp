@@ -0,0 +1,205 @@
+#include "preprocess.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VISION_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VISION_NEON 1
+#endif
+
+// out[i] = r0[i] * w0 + r1[i] * w1 for n interleaved bytes
+static void blendRows(const uint8_t* r0, const uint8_t* r1, float w0, float w1,
+                      float* out, int n) {
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256 vw0 = _mm256_set1_ps(w0);
+    const __m256 vw1 = _mm256_set1_ps(w1);
+    for (; i + 8 <= n; i += 8) {
+        __m256 a = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(r0 + i))));
+        __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(r1 + i))));
+#if defined(__FMA__)
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(b, vw1, _mm256_mul_ps(a, vw0)));
+#else
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(a, vw0), _mm256_mul_ps(b, vw1)));
+#endif
+    }
+#elif defined(VISION_SSE2)
+    const __m128 vw0 = _mm_set1_ps(w0);
+    const __m128 vw1 = _mm_set1_ps(w1);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + i));
+        __m128i a16[2] = {_mm_unpacklo_epi8(a, zero), _mm_unpackhi_epi8(a, zero)};
+        __m128i b16[2] = {_mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero)};
+        for (int h = 0; h < 2; h++) {
+            __m128 alo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(a16[h], zero));
+            __m128 ahi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(a16[h], zero));
+            __m128 blo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(b16[h], zero));
+            __m128 bhi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(b16[h], zero));
+            _mm_storeu_ps(out + i + h * 8,
+                          _mm_add_ps(_mm_mul_ps(alo, vw0), _mm_mul_ps(blo, vw1)));
+            _mm_storeu_ps(out + i + h * 8 + 4,
+                          _mm_add_ps(_mm_mul_ps(ahi, vw0), _mm_mul_ps(bhi, vw1)));
+        }
+    }
+#elif defined(VISION_NEON)
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t a = vmovl_u8(vld1_u8(r0 + i));
+        uint16x8_t b = vmovl_u8(vld1_u8(r1 + i));
+        float32x4_t alo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(a)));
+        float32x4_t ahi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(a)));
+        float32x4_t blo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(b)));
+        float32x4_t bhi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(b)));
+        vst1q_f32(out + i, vmlaq_n_f32(vmulq_n_f32(alo, w0), blo, w1));
+        vst1q_f32(out + i + 4, vmlaq_n_f32(vmulq_n_f32(ahi, w0), bhi, w1));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = r0[i] * w0 + r1[i] * w1;
+    }
+}
+
+// Horizontal resample of one blended BGR row into the R, G, B planes
+static void resampleRow(const float* row, const int32_t* ofs0, const int32_t* ofs1,
+                        const float* alpha, int n, float* outR, float* outG, float* outB) {
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; x + 8 <= n; x += 8) {
+        __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ofs0 + x));
+        __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ofs1 + x));
+        __m256 a = _mm256_loadu_ps(alpha + x);
+        __m256 ia = _mm256_sub_ps(one, a);
+        float* planes[3] = {outB, outG, outR};
+        for (int c = 0; c < 3; c++) {
+            __m256 p0 = _mm256_i32gather_ps(row + c, i0, 4);
+            __m256 p1 = _mm256_i32gather_ps(row + c, i1, 4);
+            _mm256_storeu_ps(planes[c] + x,
+                             _mm256_add_ps(_mm256_mul_ps(p0, ia), _mm256_mul_ps(p1, a)));
+        }
+    }
+#endif
+    for (; x < n; x++) {
+        const float* p0 = row + ofs0[x];
+        const float* p1 = row + ofs1[x];
+        float a = alpha[x];
+        float ia = 1.0f - a;
+        outB[x] = p0[0] * ia + p1[0] * a;
+        outG[x] = p0[1] * ia + p1[1] * a;
+        outR[x] = p0[2] * ia + p1[2] * a;
+    }
+}
+
+Preprocessor::Preprocessor(int dstWidth, int dstHeight)
+    : dstWidth_(dstWidth), dstHeight_(dstHeight) {
+}
+
+void Preprocessor::setOutputSize(int dstWidth, int dstHeight) {
+    if (dstWidth == dstWidth_ && dstHeight == dstHeight_) return;
+    dstWidth_ = dstWidth;
+    dstHeight_ = dstHeight;
+    srcWidth_ = 0;  // force table rebuild
+    srcHeight_ = 0;
+}
+
+LetterboxTransform Preprocessor::computeTransform(int srcWidth, int srcHeight,
+                                                  int dstWidth, int dstHeight) {
+    LetterboxTransform t;
+    t.scale = std::min(static_cast<float>(dstWidth) / srcWidth,
+                       static_cast<float>(dstHeight) / srcHeight);
+    int contentW = std::min(dstWidth, static_cast<int>(std::lround(srcWidth * t.scale)));
+    int contentH = std::min(dstHeight, static_cast<int>(std::lround(srcHeight * t.scale)));
+    t.padX = static_cast<float>((dstWidth - contentW) / 2);
+    t.padY = static_cast<float>((dstHeight - contentH) / 2);
+    return t;
+}
+
+void Preprocessor::prepare(int srcWidth, int srcHeight) {
+    if (srcWidth == srcWidth_ && srcHeight == srcHeight_) return;
+    srcWidth_ = srcWidth;
+    srcHeight_ = srcHeight;
+
+    transform_ = computeTransform(srcWidth, srcHeight, dstWidth_, dstHeight_);
+    contentWidth_ = std::min(dstWidth_, static_cast<int>(std::lround(srcWidth * transform_.scale)));
+    contentHeight_ = std::min(dstHeight_, static_cast<int>(std::lround(srcHeight * transform_.scale)));
+    padLeft_ = static_cast<int>(transform_.padX);
+    padTop_ = static_cast<int>(transform_.padY);
+
+    // Half-pixel centre sampling, matching cv::resize INTER_LINEAR
+    const float sx = static_cast<float>(srcWidth) / contentWidth_;
+    xOfs0_.resize(contentWidth_);
+    xOfs1_.resize(contentWidth_);
+    xAlpha_.resize(contentWidth_);
+    for (int x = 0; x < contentWidth_; x++) {
+        float fx = std::max(0.0f, (x + 0.5f) * sx - 0.5f);
+        int x0 = std::min(static_cast<int>(fx), srcWidth - 1);
+        int x1 = std::min(x0 + 1, srcWidth - 1);
+        xOfs0_[x] = x0 * 3;
+        xOfs1_[x] = x1 * 3;
+        xAlpha_[x] = (x0 == x1) ? 0.0f : fx - x0;
+    }
+
+    const float sy = static_cast<float>(srcHeight) / contentHeight_;
+    yRow0_.resize(contentHeight_);
+    yRow1_.resize(contentHeight_);
+    yAlpha_.resize(contentHeight_);
+    for (int y = 0; y < contentHeight_; y++) {
+        float fy = std::max(0.0f, (y + 0.5f) * sy - 0.5f);
+        int y0 = std::min(static_cast<int>(fy), srcHeight - 1);
+        int y1 = std::min(y0 + 1, srcHeight - 1);
+        yRow0_[y] = y0;
+        yRow1_[y] = y1;
+        yAlpha_[y] = (y0 == y1) ? 0.0f : fy - y0;
+    }
+
+    rowBuf_.resize(static_cast<size_t>(srcWidth) * 3);
+}
+
+void Preprocessor::fillPadding(float* dst) const {
+    const size_t plane = static_cast<size_t>(dstWidth_) * dstHeight_;
+    const int padRight = dstWidth_ - contentWidth_ - padLeft_;
+    const int padBottom = dstHeight_ - contentHeight_ - padTop_;
+
+    for (int c = 0; c < 3; c++) {
+        float* p = dst + c * plane;
+        std::fill(p, p + static_cast<size_t>(padTop_) * dstWidth_, PAD_VALUE);
+        std::fill(p + static_cast<size_t>(padTop_ + contentHeight_) * dstWidth_,
+                  p + static_cast<size_t>(padTop_ + contentHeight_ + padBottom) * dstWidth_,
+                  PAD_VALUE);
+        if (padLeft_ == 0 && padRight == 0) continue;
+        for (int y = padTop_; y < padTop_ + contentHeight_; y++) {
+            float* row = p + static_cast<size_t>(y) * dstWidth_;
+            std::fill(row, row + padLeft_, PAD_VALUE);
+            std::fill(row + padLeft_ + contentWidth_, row + dstWidth_, PAD_VALUE);
+        }
+    }
+}
+
+LetterboxTransform Preprocessor::run(const cv::Mat& frame, float* dst) {
+    CV_Assert(frame.type() == CV_8UC3);
+    prepare(frame.cols, frame.rows);
+    fillPadding(dst);
+
+    const size_t plane = static_cast<size_t>(dstWidth_) * dstHeight_;
+    const int rowElems = frame.cols * 3;
+    constexpr float inv255 = 1.0f / 255.0f;
+
+    for (int y = 0; y < contentHeight_; y++) {
+        float a = yAlpha_[y];
+        blendRows(frame.ptr<uint8_t>(yRow0_[y]), frame.ptr<uint8_t>(yRow1_[y]),
+                  (1.0f - a) * inv255, a * inv255, rowBuf_.data(), rowElems);
+
+        size_t outOfs = static_cast<size_t>(padTop_ + y) * dstWidth_ + padLeft_;
+        resampleRow(rowBuf_.data(), xOfs0_.data(), xOfs1_.data(), xAlpha_.data(),
+                    contentWidth_, dst + outOfs, dst + plane + outOfs, dst + 2 * plane + outOfs);
+    }
+    return transform_;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// Mapping between frame pixels and the letterboxed network input.
+// modelX = frameX * scale + padX (same for y).
+struct LetterboxTransform {
+    float scale = 1.0f;
+    float padX = 0.0f;
+    float padY = 0.0f;
+
+    cv::Point2f toFrame(float x, float y) const {
+        return cv::Point2f((x - padX) / scale, (y - padY) / scale);
+    }
+
+    cv::Rect2f toFrame(const cv::Rect2f& r) const {
+        return cv::Rect2f((r.x - padX) / scale, (r.y - padY) / scale,
+                          r.width / scale, r.height / scale);
+    }
+
+    cv::Point2f toModel(float x, float y) const {
+        return cv::Point2f(x * scale + padX, y * scale + padY);
+    }
+};
+
+// Fused BGR uint8 -> letterboxed, normalized, planar RGB float kernel.
+// Replaces resize + convertTo + cvtColor + HWC->CHW with a single pass:
+// every destination row is produced by one vertical blend of two source
+// rows (SIMD) followed by a horizontal resample that writes straight into
+// the R, G and B planes. Scale tables are cached per source size, so the
+// steady state performs no allocations.
+class Preprocessor {
+public:
+    static constexpr float PAD_VALUE = 114.0f / 255.0f;  // YOLOv8 letterbox grey
+
+    Preprocessor(int dstWidth, int dstHeight);
+
+    // Writes 3 * dstHeight * dstWidth floats to dst (R plane, G plane, B plane).
+    // frame must be CV_8UC3 BGR.
+    LetterboxTransform run(const cv::Mat& frame, float* dst);
+
+    // Change the destination size; tables are rebuilt on the next run().
+    void setOutputSize(int dstWidth, int dstHeight);
+
+    int outputWidth() const { return dstWidth_; }
+    int outputHeight() const { return dstHeight_; }
+
+    // Geometry of the letterbox run() would use for a frame of this size.
+    static LetterboxTransform computeTransform(int srcWidth, int srcHeight,
+                                               int dstWidth, int dstHeight);
+
+private:
+    void prepare(int srcWidth, int srcHeight);
+    void fillPadding(float* dst) const;
+
+    int dstWidth_;
+    int dstHeight_;
+
+    // Cached geometry for the last source size seen
+    int srcWidth_ = 0;
+    int srcHeight_ = 0;
+    int contentWidth_ = 0;
+    int contentHeight_ = 0;
+    int padLeft_ = 0;
+    int padTop_ = 0;
+    LetterboxTransform transform_;
+
+    // Horizontal taps: element offsets (x * 3) into a source row and blend weight
+    std::vector<int32_t> xOfs0_;
+    std::vector<int32_t> xOfs1_;
+    std::vector<float> xAlpha_;
+    // Vertical taps: source rows and blend weight
+    std::vector<int32_t> yRow0_;
+    std::vector<int32_t> yRow1_;
+    std::vector<float> yAlpha_;
+    // One vertically blended source row, interleaved BGR, already scaled to [0,1]
+    std::vector<float> rowBuf_;
+};
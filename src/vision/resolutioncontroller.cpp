@@ -0,0 +1,61 @@
+#include "resolutioncontroller.h"
+#include <algorithm>
+
+ResolutionController::ResolutionController(const ResolutionControllerConfig& config)
+    : config_(config) {
+    if (config_.sizes.empty()) config_.sizes = {640};
+    std::sort(config_.sizes.begin(), config_.sizes.end());
+    current_ = config_.sizes.size() - 1;  // start at full resolution
+    framesPerSize_.assign(config_.sizes.size(), 0);
+}
+
+// Run time scales roughly with input pixels
+double ResolutionController::predictMs(size_t index) const {
+    double ratio = static_cast<double>(config_.sizes[index]) / config_.sizes[current_];
+    return smoothedMs_ * ratio * ratio;
+}
+
+void ResolutionController::switchTo(size_t index) {
+    smoothedMs_ = predictMs(index);
+    current_ = index;
+    headroomFrames_ = 0;
+}
+
+void ResolutionController::update(double runMs) {
+    framesPerSize_[current_]++;
+    smoothedMs_ = smoothedMs_ > 0.0 ? config_.smoothing * runMs + (1.0 - config_.smoothing) * smoothedMs_
+                                    : runMs;
+
+    if (smoothedMs_ > config_.budgetMs && current_ > 0) {
+        size_t target = 0;
+        for (size_t i = current_; i-- > 0;) {
+            if (predictMs(i) <= config_.budgetMs) {
+                target = i;
+                break;
+            }
+        }
+        switchTo(target);
+        downshifts_++;
+        return;
+    }
+
+    if (current_ + 1 < config_.sizes.size() &&
+        predictMs(current_ + 1) < config_.budgetMs * config_.upshiftHeadroom) {
+        if (++headroomFrames_ >= config_.upshiftFrames) {
+            switchTo(current_ + 1);
+            upshifts_++;
+        }
+    } else {
+        headroomFrames_ = 0;
+    }
+}
+
+ResolutionControllerStats ResolutionController::stats() const {
+    ResolutionControllerStats s;
+    s.inputSize = inputSize();
+    s.smoothedMs = smoothedMs_;
+    s.downshifts = downshifts_;
+    s.upshifts = upshifts_;
+    s.framesPerSize = framesPerSize_;
+    return s;
+}
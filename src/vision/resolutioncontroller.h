@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ResolutionControllerConfig {
+    double budgetMs = 25.0;            // Session::Run time to stay under
+    std::vector<int> sizes{320, 416, 512, 640};  // ascending square input sides
+    double smoothing = 0.2;            // EWMA weight of the newest latency sample
+    int upshiftFrames = 30;            // frames with headroom before stepping up
+    double upshiftHeadroom = 0.8;      // next size must be predicted under budget * this
+};
+
+struct ResolutionControllerStats {
+    int inputSize = 0;
+    double smoothedMs = 0.0;           // EWMA latency at the current size
+    uint64_t downshifts = 0;
+    uint64_t upshifts = 0;
+    std::vector<uint64_t> framesPerSize;  // parallel to config.sizes
+};
+
+// Picks the detector input resolution per frame from a latency budget.
+// Latency is tracked as an EWMA at the current size and predicted for other
+// sizes by pixel count, so a switch needs no stale per-size history: going
+// down is immediate (to the largest size predicted to fit), going up requires
+// sustained headroom to avoid oscillating around the budget.
+class ResolutionController {
+public:
+    explicit ResolutionController(const ResolutionControllerConfig& config = ResolutionControllerConfig());
+
+    int inputSize() const { return config_.sizes[current_]; }
+
+    // Report the measured Session::Run time of a frame run at inputSize()
+    void update(double runMs);
+
+    const ResolutionControllerConfig& config() const { return config_; }
+    ResolutionControllerStats stats() const;
+
+private:
+    double predictMs(size_t index) const;
+    void switchTo(size_t index);
+
+    ResolutionControllerConfig config_;
+    size_t current_;
+    double smoothedMs_ = 0.0;
+    int headroomFrames_ = 0;
+    uint64_t downshifts_ = 0;
+    uint64_t upshifts_ = 0;
+    std::vector<uint64_t> framesPerSize_;
+};
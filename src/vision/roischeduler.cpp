@@ -0,0 +1,68 @@
+#include "roischeduler.h"
+#include <algorithm>
+
+RoiScheduler::RoiScheduler(const RoiSchedulerConfig& config) : config_(config) {}
+
+InferenceMode RoiScheduler::decide(const std::vector<cv::Rect>& trackBoxes, const cv::Size& frameSize,
+                                   std::vector<cv::Rect>& regions) {
+    regions.clear();
+    if (!haveKeyframe_ || framesSinceKeyframe_ + 1 >= config_.keyframeInterval) {
+        stats_.intervalKeyframes++;
+        return InferenceMode::Keyframe;
+    }
+    if (trackBoxes.empty()) {
+        stats_.noTrackKeyframes++;
+        return InferenceMode::Keyframe;
+    }
+
+    // Expand each track by the margin (objects move between detections)
+    const cv::Rect frameRect(0, 0, frameSize.width, frameSize.height);
+    for (const cv::Rect& box : trackBoxes) {
+        int width = std::max(config_.minRoiSize, static_cast<int>(box.width * (1.0f + 2.0f * config_.roiMargin)));
+        int height = std::max(config_.minRoiSize, static_cast<int>(box.height * (1.0f + 2.0f * config_.roiMargin)));
+        cv::Rect region(box.x + box.width / 2 - width / 2, box.y + box.height / 2 - height / 2, width, height);
+        region &= frameRect;
+        if (region.width > 0 && region.height > 0) regions.push_back(region);
+    }
+
+    // Merge overlapping regions so shared pixels go through the network once
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < regions.size() && !merged; i++) {
+            for (size_t j = i + 1; j < regions.size(); j++) {
+                if ((regions[i] & regions[j]).area() > 0) {
+                    regions[i] |= regions[j];
+                    regions.erase(regions.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (static_cast<int>(regions.size()) > config_.maxRois) {
+        regions.clear();
+        stats_.crowdedKeyframes++;
+        return InferenceMode::Keyframe;
+    }
+    return InferenceMode::Roi;
+}
+
+void RoiScheduler::reportKeyframe(int inputSize) {
+    stats_.keyframes++;
+    stats_.keyframePixels += static_cast<uint64_t>(inputSize) * inputSize;
+    framesSinceKeyframe_ = 0;
+    haveKeyframe_ = true;
+}
+
+void RoiScheduler::reportRoiFrame(int inputSize) {
+    stats_.roiFrames++;
+    stats_.roiPixels += static_cast<uint64_t>(inputSize) * inputSize;
+    framesSinceKeyframe_++;
+}
+
+void RoiScheduler::reportFallback(int inputSize) {
+    stats_.fallbackKeyframes++;
+    reportKeyframe(inputSize);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+struct RoiSchedulerConfig {
+    int keyframeInterval = 10;   // full-frame detection at least every N inferred frames
+    float roiMargin = 0.3f;      // track boxes grow by this fraction of their size per side
+    int minRoiSize = 96;         // ... and to at least this many frame pixels
+    int maxRois = 8;             // more regions than this: run a keyframe instead
+};
+
+enum class InferenceMode {
+    Keyframe,  // full frame
+    Roi        // only the regions around existing tracks
+};
+
+struct RoiSchedulerStats {
+    uint64_t keyframes = 0;
+    uint64_t roiFrames = 0;
+    // Why each keyframe was chosen
+    uint64_t intervalKeyframes = 0;   // keyframe interval elapsed
+    uint64_t noTrackKeyframes = 0;    // nothing to track
+    uint64_t crowdedKeyframes = 0;    // more than maxRois regions
+    uint64_t fallbackKeyframes = 0;   // ROI pass could not run (fixed-size model, did not fit)
+    // Network input pixels, to compare against keyframes-only
+    uint64_t keyframePixels = 0;
+    uint64_t roiPixels = 0;
+};
+
+// Chooses between full-frame keyframes and ROI-only inference around the
+// tracker's boxes. Keyframes find new objects; ROI frames keep existing tracks
+// fresh at a fraction of the pixels.
+class RoiScheduler {
+public:
+    explicit RoiScheduler(const RoiSchedulerConfig& config = RoiSchedulerConfig());
+
+    // Decide for the next inferred frame. On Roi, regions holds the expanded,
+    // merged track regions to detect in.
+    InferenceMode decide(const std::vector<cv::Rect>& trackBoxes, const cv::Size& frameSize,
+                         std::vector<cv::Rect>& regions);
+
+    // Outcome of the frame decide() was called for; inputSize is the square
+    // network input side that was run
+    void reportKeyframe(int inputSize);
+    void reportRoiFrame(int inputSize);
+    void reportFallback(int inputSize);  // Roi was chosen but a keyframe ran instead
+
+    const RoiSchedulerConfig& config() const { return config_; }
+    const RoiSchedulerStats& stats() const { return stats_; }
+
+private:
+    RoiSchedulerConfig config_;
+    RoiSchedulerStats stats_;
+    int framesSinceKeyframe_ = 0;
+    bool haveKeyframe_ = false;
+};
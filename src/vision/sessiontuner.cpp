@@ -0,0 +1,84 @@
+#include "sessiontuner.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+static constexpr int WARMUP_RUNS = 3;
+
+std::vector<SessionConfig> defaultSessionCandidates(const SessionConfig& base) {
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    for (int threads : {1, 2, 4, cores / 2, cores}) {
+        if (threads >= 1 && threads <= cores &&
+            std::find(threadCounts.begin(), threadCounts.end(), threads) == threadCounts.end()) {
+            threadCounts.push_back(threads);
+        }
+    }
+
+    std::vector<std::vector<std::string>> providerSets = {base.providers};
+    std::vector<std::string> available = Ort::GetAvailableProviders();
+    bool haveXnnpack = std::find(available.begin(), available.end(), "XnnpackExecutionProvider") != available.end();
+    bool baseHasXnnpack = std::find(base.providers.begin(), base.providers.end(), "XNNPACK") != base.providers.end();
+    if (haveXnnpack && !baseHasXnnpack) {
+        providerSets.push_back(base.providers);
+        providerSets.back().push_back("XNNPACK");
+    }
+
+    std::vector<SessionConfig> candidates;
+    for (const auto& providers : providerSets) {
+        for (int threads : threadCounts) {
+            for (bool spinning : {true, false}) {
+                SessionConfig config = base;
+                config.intraOpThreads = threads;
+                config.allowSpinning = spinning;
+                config.providers = providers;
+                candidates.push_back(config);
+            }
+        }
+    }
+    return candidates;
+}
+
+bool tuneSession(const std::string& modelPath, const std::vector<SessionConfig>& candidates, int iterations,
+                 std::vector<SessionTuningResult>& results, SessionConfig& best) {
+    using Clock = std::chrono::steady_clock;
+    iterations = std::max(1, iterations);
+
+    // Every candidate sees the same noise frame
+    cv::Mat frame(720, 1280, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    results.clear();
+    double bestMs = -1.0;
+    std::vector<Detection> detections;
+    std::vector<double> times;
+    for (const SessionConfig& config : candidates) {
+        SessionTuningResult result;
+        result.config = config;
+        result.medianMs = -1.0;
+
+        VisionModule vision(modelPath);  // no model cache: every candidate builds its own graph
+        vision.setSessionConfig(config);
+        if (vision.init()) {
+            for (int i = 0; i < WARMUP_RUNS; i++) vision.detect(frame, detections);
+            times.clear();
+            for (int i = 0; i < iterations; i++) {
+                auto start = Clock::now();
+                vision.detect(frame, detections);
+                times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+            std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+            result.medianMs = times[times.size() / 2];
+            if (bestMs < 0.0 || result.medianMs < bestMs) {
+                bestMs = result.medianMs;
+                best = config;
+            }
+        }
+        std::cout << "  " << config.describe() << ": "
+                  << (result.medianMs < 0.0 ? std::string("failed") : std::to_string(result.medianMs) + " ms")
+                  << std::endl;
+        results.push_back(result);
+    }
+    return bestMs >= 0.0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "visionmodule.h"
+#include <string>
+#include <vector>
+
+struct SessionTuningResult {
+    SessionConfig config;
+    double medianMs = 0.0;  // per detect() on the synthetic frame; < 0 if the session failed
+};
+
+// Candidates for the startup self-benchmark, derived from base: intra-op
+// thread counts up to the core count, with and without spinning, and the
+// same again with XNNPACK when this ONNX Runtime build has it.
+std::vector<SessionConfig> defaultSessionCandidates(const SessionConfig& base);
+
+// Builds one session per candidate, times `iterations` detect() calls on a
+// synthetic 1280x720 frame after a short warm-up, and returns the fastest in
+// best. results gets one entry per candidate. False if no candidate initialised.
+bool tuneSession(const std::string& modelPath, const std::vector<SessionConfig>& candidates, int iterations,
+                 std::vector<SessionTuningResult>& results, SessionConfig& best);
@@ -1,32 +1,80 @@
 #include "visionmodule.h"
 #include "coco_labels.h"
+#include "decoder.h"
+#include "modelcache.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <onnxruntime/onnxruntime_cxx_api.h>
 #include <iostream>
 #include <algorithm>
+#include <unordered_map>
 
 static constexpr int INPUT_WIDTH = 640;
 static constexpr int INPUT_HEIGHT = 640;
-static constexpr float CONF_THRESH = 0.25f;  // Lowered for better detection of non-person objects
-static constexpr float NMS_THRESH = 0.4f;
+static constexpr int MOSAIC_SIZES[] = {320, 416, 512, 640};
 
-struct Candidate {
-    cv::Rect box;
-    float score;
-    int classId;
-};
+// YOLOv8 predicts one box per cell of its stride 8, 16 and 32 grids
+static int64_t anchorCount(int width, int height) {
+    return (width / 8) * (height / 8) + (width / 16) * (height / 16) + (width / 32) * (height / 32);
+}
 
-static float iou(const cv::Rect& a, const cv::Rect& b) {
-    float inter = (a & b).area();
-    float uni = a.area() + b.area() - inter;
-    return (uni > 0) ? inter / uni : 0.0f;
+// Model output shape with the dynamic batch/anchor dims resolved for an
+// input of [batch, 3, height, width]. End-to-end outputs ([N, maxDet, 6])
+// only have a dynamic batch.
+static std::vector<int64_t> resolveOutputShape(std::vector<int64_t> shape, int64_t batch,
+                                               int width, int height) {
+    if (shape.size() == 3) {
+        if (shape[0] <= 0) shape[0] = batch;
+        if (shape[2] <= 0 && shape[1] > 0) shape[2] = anchorCount(width, height);
+    }
+    return shape;
 }
 
 VisionModule::VisionModule(const std::string& modelPath)
-    : modelPath_(modelPath), env_(ORT_LOGGING_LEVEL_WARNING, "Vision") {
+    : modelPath_(modelPath), env_(ORT_LOGGING_LEVEL_WARNING, "Vision"),
+      preprocessor_(INPUT_WIDTH, INPUT_HEIGHT) {
     session_ = nullptr;
+    applyClassPolicies();
+}
+
+bool VisionModule::loadClassPolicies(const std::string& path) {
+    if (!policies_.loadOverrides(path)) return false;
+    applyClassPolicies();
+    return true;
+}
+
+void VisionModule::setClassPolicies(const ClassPolicyTable& policies) {
+    policies_ = policies;
+    applyClassPolicies();
+}
+
+// Push the per-class NMS thresholds into every engine
+void VisionModule::applyClassPolicies() {
+    for (int c = 0; c < ClassPolicyTable::NUM_CLASSES; c++) {
+        scratch_.nms.setClassThreshold(c, policies_[c].nmsThreshold);
+        for (FrameScratch& scratch : batchScratch_) {
+            scratch.nms.setClassThreshold(c, policies_[c].nmsThreshold);
+        }
+    }
+}
+
+// Class thresholds plus scratch sized for a cluttered frame up front
+void VisionModule::configureScratch(FrameScratch& scratch) {
+    for (int c = 0; c < ClassPolicyTable::NUM_CLASSES; c++) {
+        scratch.nms.setClassThreshold(c, policies_[c].nmsThreshold);
+    }
+    scratch.decoded.reserve(1024);
+    scratch.candidates.reserve(1024);
+    scratch.nms.reserve(1024);
 }
 
 VisionModule::~VisionModule() {
+    // Bindings reference the session, release them first
+    ioBinding_.reset();
+    batchBinding_.reset();
+    sizedBindings_.clear();
     if (session_) {
         delete session_;
         session_ = nullptr;
@@ -44,7 +92,8 @@ VisionModule::~VisionModule() {
 bool VisionModule::init() {
     try {
         sessionOptions_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
-        session_ = new Ort::Session(env_, modelPath_.c_str(), sessionOptions_);
+        applySessionConfig();
+        createSession();
 
         size_t numInputNodes = session_->GetInputCount();
         inputNodeNames_.resize(numInputNodes);
@@ -59,6 +108,32 @@ bool VisionModule::init() {
             auto name = session_->GetOutputNameAllocated(i, Ort::AllocatorWithDefaultOptions());
             outputNodeNames_[i] = strdup(name.get());
         }
+
+        // Float input/output is all the preprocessing and decoder handle; INT8
+        // QDQ models keep both in float and only quantize inside the graph
+        if (session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ||
+            session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+            std::cerr << "Vision model must have float input/output (quantize in QDQ format)" << std::endl;
+            return false;
+        }
+        // Precision tag written by tools/quantize_yolo.py
+        Ort::ModelMetadata metadata = session_->GetModelMetadata();
+        auto precision = metadata.LookupCustomMetadataMapAllocated("quantization", Ort::AllocatorWithDefaultOptions());
+        modelPrecision_ = precision ? precision.get() : "fp32";
+
+        // Anchor grid (YOLOv8) or final boxes (YOLOv10-style end-to-end)
+        auto layoutHint = metadata.LookupCustomMetadataMapAllocated("output_layout", Ort::AllocatorWithDefaultOptions());
+        outputLayout_ = detectOutputLayout(session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape(),
+                                           layoutHint ? layoutHint.get() : nullptr);
+        std::cout << "Vision model: " << modelPath_ << " (" << modelPrecision_ << ", "
+                  << outputLayoutName(outputLayout_) << " output)" << std::endl;
+
+        // A dynamic leading dimension means the model accepts [N,3,H,W]
+        std::vector<int64_t> modelInputShape = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        dynamicBatch_ = !modelInputShape.empty() && modelInputShape[0] <= 0;
+        dynamicInputSize_ = modelInputShape.size() == 4 && modelInputShape[2] <= 0 && modelInputShape[3] <= 0;
+
+        bindTensors();
         return true;
     } catch (const Ort::Exception& e) {
         std::cerr << "ONNX Runtime init failed: " << e.what() << std::endl;
@@ -66,256 +141,699 @@ bool VisionModule::init() {
     }
 }
 
-cv::Mat VisionModule::preprocess(const cv::Mat& frame) {
-    cv::Mat resized;
-    cv::resize(frame, resized, cv::Size(INPUT_WIDTH, INPUT_HEIGHT));
-    resized.convertTo(resized, CV_32F, 1.0 / 255.0);
-    cv::cvtColor(resized, resized, cv::COLOR_BGR2RGB);
-    return resized;
+std::string SessionConfig::describe() const {
+    std::string text = "intra=" + std::to_string(intraOpThreads) + " inter=" + std::to_string(interOpThreads);
+    text += allowSpinning ? " spin" : " nospin";
+    text += parallelExecution ? " par" : " seq";
+    if (!memoryPattern) text += " nomempattern";
+    if (!cpuArena) text += " noarena";
+    for (const std::string& provider : providers) text += " " + provider;
+    return text;
+}
+
+// Maps sessionConfig_ onto sessionOptions_. Providers ORT was built without
+// are skipped with a warning; the CPU EP always remains as the fallback.
+void VisionModule::applySessionConfig() {
+    const SessionConfig& config = sessionConfig_;
+    if (config.intraOpThreads > 0) sessionOptions_.SetIntraOpNumThreads(config.intraOpThreads);
+    if (config.interOpThreads > 0) sessionOptions_.SetInterOpNumThreads(config.interOpThreads);
+    if (!config.allowSpinning) {
+        sessionOptions_.AddConfigEntry("session.intra_op.allow_spinning", "0");
+        sessionOptions_.AddConfigEntry("session.inter_op.allow_spinning", "0");
+    }
+    sessionOptions_.SetExecutionMode(config.parallelExecution ? ExecutionMode::ORT_PARALLEL
+                                                              : ExecutionMode::ORT_SEQUENTIAL);
+    if (config.memoryPattern) sessionOptions_.EnableMemPattern();
+    else sessionOptions_.DisableMemPattern();
+    if (config.cpuArena) sessionOptions_.EnableCpuMemArena();
+    else sessionOptions_.DisableCpuMemArena();
+
+    std::vector<std::string> available = Ort::GetAvailableProviders();
+    for (const std::string& provider : config.providers) {
+        std::string lower = provider;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        bool found = std::any_of(available.begin(), available.end(), [&](std::string name) {
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            return name.rfind(lower, 0) == 0;  // "xnnpack" matches "XnnpackExecutionProvider"
+        });
+        if (!found) {
+            std::cerr << "Execution provider " << provider << " not available in this ONNX Runtime build" << std::endl;
+            continue;
+        }
+        try {
+            std::unordered_map<std::string, std::string> providerOptions;
+            // XNNPACK keeps its own thread pool; give it the same intra-op budget
+            if (lower == "xnnpack" && config.intraOpThreads > 0) {
+                providerOptions["intra_op_num_threads"] = std::to_string(config.intraOpThreads);
+            }
+            // The generic AppendExecutionProvider takes upper-case names ("XNNPACK", "QNN", ...)
+            std::string upper = lower;
+            std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+            sessionOptions_.AppendExecutionProvider(upper, providerOptions);
+        } catch (const Ort::Exception& e) {
+            std::cerr << "Could not enable execution provider " << provider << ": " << e.what() << std::endl;
+        }
+    }
+    std::cout << "Vision session options: " << config.describe() << std::endl;
+}
+
+// Everything in the session options that changes the optimized graph: the
+// level and the EPs it was partitioned for (thread counts do not matter)
+std::string VisionModule::optimizationKey() const {
+    std::string key = "opt=extended";
+    for (const std::string& provider : sessionConfig_.providers) key += ";ep=" + provider;
+    return key;
+}
+
+Ort::Session* VisionModule::openSession(const std::string& path, const Ort::SessionOptions& options) {
+    if (prepackedWeights_) return new Ort::Session(env_, path.c_str(), options, *prepackedWeights_);
+    return new Ort::Session(env_, path.c_str(), options);
+}
+
+// Creates session_. With a cache directory set, the first start saves ORT's
+// optimized graph and later starts load it with optimizations disabled.
+void VisionModule::createSession() {
+    using Clock = std::chrono::steady_clock;
+    const std::string cachePath = modelCacheDir_.empty()
+        ? std::string() : optimizedModelPath(modelCacheDir_, modelPath_, optimizationKey());
+
+    if (!cachePath.empty() && std::filesystem::exists(cachePath)) {
+        try {
+            Ort::SessionOptions warmOptions = sessionOptions_.Clone();
+            warmOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            auto start = Clock::now();
+            session_ = openSession(cachePath, warmOptions);
+            sessionCreateMs_ = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            sessionFromCache_ = true;
+            std::cout << "Vision session: warm start from " << cachePath << " in " << sessionCreateMs_
+                      << " ms (cold start: " << readColdStartMs(cachePath) << " ms)" << std::endl;
+            return;
+        } catch (const Ort::Exception& e) {
+            std::cerr << "Discarding unreadable model cache " << cachePath << ": " << e.what() << std::endl;
+            std::filesystem::remove(cachePath);
+        }
+    }
+
+    // Written under a temporary name so an interrupted start never leaves a
+    // truncated cache entry behind
+    Ort::SessionOptions coldOptions = sessionOptions_.Clone();
+    const std::string partialPath = cachePath + ".partial";
+    if (!cachePath.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(modelCacheDir_, ec);
+        coldOptions.SetOptimizedModelFilePath(partialPath.c_str());
+    }
+    auto start = Clock::now();
+    session_ = openSession(modelPath_, coldOptions);
+    sessionCreateMs_ = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    sessionFromCache_ = false;
+
+    std::cout << "Vision session: cold start in " << sessionCreateMs_ << " ms" << std::endl;
+    if (!cachePath.empty()) {
+        std::error_code ec;
+        std::filesystem::rename(partialPath, cachePath, ec);
+        if (ec) {
+            std::cerr << "Could not cache optimized model at " << cachePath << ": " << ec.message() << std::endl;
+        } else {
+            writeColdStartMs(cachePath, sessionCreateMs_);
+            std::cout << "Optimized model cached at " << cachePath << std::endl;
+        }
+    }
+}
+
+// Allocates the 64-byte aligned input/output tensors once and binds them, so
+// steady-state inference writes into the same memory every frame.
+void VisionModule::bindTensors() {
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    ioBinding_ = std::make_unique<Ort::IoBinding>(*session_);
+
+    inputShape_ = {1, 3, INPUT_HEIGHT, INPUT_WIDTH};
+    size_t inputSize = 3 * INPUT_HEIGHT * INPUT_WIDTH;
+    inputBuffer_.reserve(inputSize);
+    inputTensor_ = Ort::Value::CreateTensor<float>(memoryInfo, inputBuffer_.data(), inputSize,
+                                                   inputShape_.data(), inputShape_.size());
+    ioBinding_->BindInput(inputNodeNames_[0], inputTensor_);
+
+    // YOLOv8 output: [1, 84, 8400] (end-to-end: [1, 300, 6]). Dynamic dims fall
+    // back to ORT-allocated output.
+    outputShape_ = resolveOutputShape(session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape(),
+                                      1, INPUT_WIDTH, INPUT_HEIGHT);
+    staticOutput_ = !outputShape_.empty();
+    size_t outputSize = 1;
+    for (int64_t d : outputShape_) {
+        if (d <= 0) staticOutput_ = false;
+        else outputSize *= static_cast<size_t>(d);
+    }
+
+    if (staticOutput_) {
+        outputBuffer_.reserve(outputSize);
+        outputTensor_ = Ort::Value::CreateTensor<float>(memoryInfo, outputBuffer_.data(), outputSize,
+                                                        outputShape_.data(), outputShape_.size());
+        ioBinding_->BindOutput(outputNodeNames_[0], outputTensor_);
+    } else {
+        std::cerr << "Vision model has dynamic output shape; output is allocated per run" << std::endl;
+        ioBinding_->BindOutput(outputNodeNames_[0], memoryInfo);
+    }
+
+    configureScratch(scratch_);
+}
+
+// (Re)binds the batch tensors for count images. Only called when the batch
+// size changes; buffers grow to the largest batch seen and are then reused.
+void VisionModule::bindBatch(size_t count) {
+    if (count == boundBatch_) return;
+
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    batchBinding_ = std::make_unique<Ort::IoBinding>(*session_);
+
+    const int64_t batch = static_cast<int64_t>(count);
+    batchInputShape_ = {batch, 3, INPUT_HEIGHT, INPUT_WIDTH};
+    size_t inputSize = count * 3 * INPUT_HEIGHT * INPUT_WIDTH;
+    batchInputBuffer_.reserve(inputSize);
+    batchInputTensor_ = Ort::Value::CreateTensor<float>(memoryInfo, batchInputBuffer_.data(), inputSize,
+                                                        batchInputShape_.data(), batchInputShape_.size());
+    batchBinding_->BindInput(inputNodeNames_[0], batchInputTensor_);
+
+    batchOutputShape_ = resolveOutputShape(session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape(),
+                                           batch, INPUT_WIDTH, INPUT_HEIGHT);
+    batchStaticOutput_ = !batchOutputShape_.empty();
+    size_t outputSize = 1;
+    for (int64_t d : batchOutputShape_) {
+        if (d <= 0) batchStaticOutput_ = false;
+        else outputSize *= static_cast<size_t>(d);
+    }
+
+    if (batchStaticOutput_) {
+        batchOutputBuffer_.reserve(outputSize);
+        batchOutputTensor_ = Ort::Value::CreateTensor<float>(memoryInfo, batchOutputBuffer_.data(), outputSize,
+                                                             batchOutputShape_.data(), batchOutputShape_.size());
+        batchBinding_->BindOutput(outputNodeNames_[0], batchOutputTensor_);
+    } else {
+        batchBinding_->BindOutput(outputNodeNames_[0], memoryInfo);
+    }
+
+    ensureBatchSlots(count);
+    boundBatch_ = count;
+}
+
+// Per-image preprocessors, letterboxes and post-processing scratch
+void VisionModule::ensureBatchSlots(size_t count) {
+    while (batchScratch_.size() < count) {
+        batchPreprocessors_.emplace_back(INPUT_WIDTH, INPUT_HEIGHT);
+        batchScratch_.emplace_back();
+        configureScratch(batchScratch_.back());
+    }
+    batchLetterbox_.resize(std::max(batchLetterbox_.size(), count));
+}
+
+VisionModule::SizedBinding& VisionModule::bindSize(int size) {
+    auto it = sizedBindings_.find(size);
+    if (it != sizedBindings_.end()) return *it->second;
+
+    auto sized = std::make_unique<SizedBinding>(size);
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    sized->binding = std::make_unique<Ort::IoBinding>(*session_);
+
+    sized->inputShape = {1, 3, size, size};
+    size_t inputSize = 3 * static_cast<size_t>(size) * size;
+    sized->inputBuffer.reserve(inputSize);
+    sized->inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, sized->inputBuffer.data(), inputSize,
+                                                         sized->inputShape.data(), sized->inputShape.size());
+    sized->binding->BindInput(inputNodeNames_[0], sized->inputTensor);
+
+    sized->outputShape = resolveOutputShape(session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape(),
+                                            1, size, size);
+    sized->staticOutput = !sized->outputShape.empty();
+    size_t outputSize = 1;
+    for (int64_t d : sized->outputShape) {
+        if (d <= 0) sized->staticOutput = false;
+        else outputSize *= static_cast<size_t>(d);
+    }
+    if (sized->staticOutput) {
+        sized->outputBuffer.reserve(outputSize);
+        sized->outputTensor = Ort::Value::CreateTensor<float>(memoryInfo, sized->outputBuffer.data(), outputSize,
+                                                              sized->outputShape.data(), sized->outputShape.size());
+        sized->binding->BindOutput(outputNodeNames_[0], sized->outputTensor);
+    } else {
+        sized->binding->BindOutput(outputNodeNames_[0], memoryInfo);
+    }
+
+    SizedBinding& ref = *sized;
+    sizedBindings_[size] = std::move(sized);
+    return ref;
+}
+
+void VisionModule::setInputSize(int size) {
+    inputSize_ = dynamicInputSize_ ? size : INPUT_WIDTH;
 }
 
 std::vector<Detection> VisionModule::detect(const cv::Mat& frame) {
     std::vector<Detection> results;
+    detect(frame, results);
+    return results;
+}
+
+void VisionModule::detect(const cv::Mat& frame, std::vector<Detection>& results) {
+    results.clear();
     
     if (frame.empty()) {
         std::cerr << "Empty frame provided to detect()" << std::endl;
-        return results;
+        return;
     }
-    
-    cv::Mat blob = preprocess(frame);
-    
-    // Convert HWC → CHW
-    std::vector<float> inputTensorValues(INPUT_HEIGHT * INPUT_WIDTH * 3);
-    for (int c = 0; c < 3; c++) {
-        for (int y = 0; y < INPUT_HEIGHT; y++) {
-            for (int x = 0; x < INPUT_WIDTH; x++) {
-                inputTensorValues[c * INPUT_HEIGHT * INPUT_WIDTH + y * INPUT_WIDTH + x] =
-                    blob.at<cv::Vec3f>(y, x)[c];
-            }
-        }
+    if (!ioBinding_) {
+        std::cerr << "detect() called before init()" << std::endl;
+        return;
     }
+    
+    try {
+        // Reduced resolutions run on their own binding; 640 uses the primary one
+        SizedBinding* sized = nullptr;
+        if (inputSize_ != INPUT_WIDTH && dynamicInputSize_) sized = &bindSize(inputSize_);
+        Preprocessor& preprocessor = sized ? sized->preprocessor : preprocessor_;
+        float* input = sized ? sized->inputBuffer.data() : inputBuffer_.data();
+        Ort::IoBinding& binding = sized ? *sized->binding : *ioBinding_;
+        const bool staticOutput = sized ? sized->staticOutput : staticOutput_;
 
-    std::vector<int64_t> inputDims = {1, 3, INPUT_HEIGHT, INPUT_WIDTH};
-    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memoryInfo, inputTensorValues.data(),
-        inputTensorValues.size(), inputDims.data(), inputDims.size());
+        // Letterbox + normalize + BGR→RGB + HWC→CHW straight into the bound input tensor
+        LetterboxTransform letterbox = preprocessor.run(frame, input);
 
-    try {
-        // Run inference
-        auto output = session_->Run(Ort::RunOptions{nullptr},
-            inputNodeNames_.data(), &inputTensor, 1,
-            outputNodeNames_.data(), outputNodeNames_.size());
+        // Run inference on the pre-bound tensors
+        auto runStart = std::chrono::steady_clock::now();
+        session_->Run(runOptions_, binding);
+        lastRunMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
 
-        // YOLOv8 output: [1, 84, 8400] → [batch, num_attrs, num_preds]
-        float* data = output[0].GetTensorMutableData<float>();
-        auto shape = output[0].GetTensorTypeAndShapeInfo().GetShape();
+        // YOLOv8 output: [1, 84, 8400] → [batch, num_attrs, num_preds];
+        // end-to-end: [1, maxDet, 6]
+        const float* data = sized ? sized->outputBuffer.data() : outputBuffer_.data();
+        std::vector<Ort::Value> dynamicOutputs;
+        std::vector<int64_t> dynamicShape;
+        if (!staticOutput) {
+            // Dynamic-shape model: ORT allocated the output for this run
+            dynamicOutputs = binding.GetOutputValues();
+            data = dynamicOutputs[0].GetTensorData<float>();
+            dynamicShape = dynamicOutputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        }
+        const std::vector<int64_t>& shape = !staticOutput ? dynamicShape : (sized ? sized->outputShape : outputShape_);
 
         // Debug output (remove in production)
        /* std::cout << "YOLO Output Shape: [";
         for (auto s : shape) std::cout << s << " ";
         std::cout << "]" << std::endl;*/
 
-        int64_t batch = shape[0];
+        writeOutputDump(data, shape);
         int64_t numAttrs = shape[1]; // 84
         int64_t numPreds = shape[2]; // 8400
+        postprocess(data, numAttrs, numPreds, letterbox, frame.size(), scratch_, results);
+    } catch (const Ort::Exception& e) {
+        std::cerr << "Inference failed: " << e.what() << std::endl;
+    }
+}
+
+void VisionModule::detectBatch(const std::vector<cv::Mat>& frames,
+                               std::vector<std::vector<Detection>>& results) {
+    detectBatch(frames.data(), frames.size(), results);
+}
+
+void VisionModule::detectBatch(const cv::Mat* frames, size_t count,
+                               std::vector<std::vector<Detection>>& results) {
+    results.resize(count);
+    if (count == 0) return;
+    if (!ioBinding_) {
+        std::cerr << "detectBatch() called before init()" << std::endl;
+        for (auto& r : results) r.clear();
+        return;
+    }
 
-        std::vector<Candidate> candidates;
-        
-        // Calculate scale factors for coordinate conversion
-        float scaleX = static_cast<float>(frame.cols) / INPUT_WIDTH;
-        float scaleY = static_cast<float>(frame.rows) / INPUT_HEIGHT;
-
-        for (int64_t i = 0; i < numPreds; i++) {
-            float x = data[0 * numPreds + i];        // x center (0-640)
-            float y = data[1 * numPreds + i];        // y center (0-640)  
-            float w = data[2 * numPreds + i];        // width (0-640)
-            float h = data[3 * numPreds + i];        // height (0-640)
-
-            // Find class with highest score
-            float maxScore = 0;
-            int classId = -1;
-            for (int64_t c = 4; c < numAttrs; c++) {
-                float score = data[c * numPreds + i];
-                if (score > maxScore) {
-                    maxScore = score;
-                    classId = static_cast<int>(c - 4);
+    // Fixed batch-1 model (or a single frame): nothing to amortize
+    if (!dynamicBatch_ || count == 1) {
+        for (size_t i = 0; i < count; i++) detect(frames[i], results[i]);
+        return;
+    }
+
+    try {
+        bindBatch(count);
+
+        // Letterbox each frame into its slice of the batch tensor, in parallel
+        const size_t inputStride = 3 * INPUT_HEIGHT * INPUT_WIDTH;
+        float* input = batchInputBuffer_.data();
+        cv::parallel_for_(cv::Range(0, static_cast<int>(count)), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                results[i].clear();
+                float* dst = input + static_cast<size_t>(i) * inputStride;
+                if (frames[i].empty()) {
+                    // Keep the slot valid; its output is ignored below
+                    std::fill(dst, dst + inputStride, Preprocessor::PAD_VALUE);
+                    continue;
                 }
+                batchLetterbox_[i] = batchPreprocessors_[i].run(frames[i], dst);
             }
+        });
 
-            if (maxScore > CONF_THRESH) {
-                // Use class-specific confidence thresholds
-                float classThreshold = CONF_THRESH;
-                
-                // Person class (0) - higher threshold since it works well
-                if (classId == 0) classThreshold = 0.5f;
-                // Common objects - lower thresholds
-                else if (classId == 56 || classId == 57) classThreshold = 0.2f; // chair, couch
-                else if (classId == 59 || classId == 60) classThreshold = 0.25f; // dining table, toilet  
-                else if (classId == 61 || classId == 62 || classId == 63) classThreshold = 0.2f; // tv, laptop, mouse
-                else if (classId == 64 || classId == 65) classThreshold = 0.25f; // remote, keyboard
-                else if (classId == 66) classThreshold = 0.2f; // cell phone
-                else if (classId == 67 || classId == 68) classThreshold = 0.25f; // microwave, oven
-                else if (classId == 73 || classId == 74) classThreshold = 0.2f; // book, clock
-                // Vehicles and larger objects
-                else if (classId >= 1 && classId <= 9) classThreshold = 0.3f; // vehicles
-                // Animals
-                else if (classId >= 14 && classId <= 23) classThreshold = 0.3f; // animals
-                // Other objects
-                else classThreshold = 0.25f;
-                
-                if (maxScore > classThreshold) {
-                    // Convert from model coordinates (0-640) to original frame coordinate
-                    float centerX = x * scaleX;
-                    float centerY = y * scaleY;
-                    float boxWidth = w * scaleX;
-                    float boxHeight = h * scaleY;
-                    
-                    int left = static_cast<int>(centerX - boxWidth / 2.0f);
-                    int top = static_cast<int>(centerY - boxHeight / 2.0f);
-                    int width = static_cast<int>(boxWidth);
-                    int height = static_cast<int>(boxHeight);
-
-                    // Clamp to frame boundaries and validate
-                    left = std::max(0, left);
-                    top = std::max(0, top);
-                    width = std::min(width, frame.cols - left);
-                    height = std::min(height, frame.rows - top);
-
-                    // Additional validation: reject boxes that are too small or too large
-                    float boxArea = static_cast<float>(width * height);
-                    float frameArea = static_cast<float>(frame.cols * frame.rows);
-                    float areaRatio = boxArea / frameArea;
-                    
-                    // Class-specific area validation
-                    float minAreaRatio = 0.0005f; // Very small objects allowed
-                    float maxAreaRatio = 0.95f;   // Allow larger objects
-                    
-                    // Person class - stricter area requirements
-                    if (classId == 0) {
-                        minAreaRatio = 0.01f;  // Persons should be reasonably sized
-                        maxAreaRatio = 0.8f;
-                    }
-                    // Small objects like phones, remotes, etc.
-                    else if (classId == 64 || classId == 66 || classId == 67) { // remote, cell phone, microwave
-                        minAreaRatio = 0.0001f; // Allow very small objects
-                    }
-                    // Large furniture
-                    else if (classId == 56 || classId == 57 || classId == 59) { // chair, couch, dining table
-                        minAreaRatio = 0.005f;  // Furniture should be reasonably sized
-                        maxAreaRatio = 0.9f;
-                    }
-                    
-                    if (width > 5 && height > 5 && areaRatio > minAreaRatio && areaRatio < maxAreaRatio && 
-                        left + width <= frame.cols && top + height <= frame.rows) {
-                        
-                        candidates.push_back({cv::Rect(left, top, width, height), maxScore, classId});
-                        
-                        // Debug: Print detection info for all classes now
-                        
-                    }
-                }
+        session_->Run(runOptions_, *batchBinding_);
+
+        // [N, 84, 8400]: image i starts at i * 84 * 8400
+        const float* data = batchOutputBuffer_.data();
+        std::vector<Ort::Value> dynamicOutputs;
+        std::vector<int64_t> dynamicShape;
+        if (!batchStaticOutput_) {
+            dynamicOutputs = batchBinding_->GetOutputValues();
+            data = dynamicOutputs[0].GetTensorData<float>();
+            dynamicShape = dynamicOutputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        }
+        const std::vector<int64_t>& shape = batchStaticOutput_ ? batchOutputShape_ : dynamicShape;
+        writeOutputDump(data, shape);
+        const int64_t numAttrs = shape[1];
+        const int64_t numPreds = shape[2];
+        const size_t outputStride = static_cast<size_t>(numAttrs * numPreds);
+
+        // Decode + NMS per image, each with its own scratch
+        cv::parallel_for_(cv::Range(0, static_cast<int>(count)), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                if (frames[i].empty()) continue;
+                postprocess(data + static_cast<size_t>(i) * outputStride, numAttrs, numPreds,
+                            batchLetterbox_[i], frames[i].size(), batchScratch_[i], results[i]);
             }
+        });
+    } catch (const Ort::Exception& e) {
+        std::cerr << "Batch inference failed: " << e.what() << std::endl;
+    }
+}
+
+int VisionModule::detectRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                                std::vector<Detection>& results) {
+    results.clear();
+    if (frame.empty() || regions.empty() || !ioBinding_ || !dynamicInputSize_) return 0;
+
+    // Same scale a keyframe uses, so objects appear at the size the detector saw them
+    const float scale = Preprocessor::computeTransform(frame.cols, frame.rows, INPUT_WIDTH, INPUT_HEIGHT).scale;
+    int canvasSize = 0;
+    for (int size : MOSAIC_SIZES) {
+        if (packMosaic(regions, frame.size(), scale, size, mosaicTiles_)) {
+            canvasSize = size;
+            break;
         }
+    }
+    if (canvasSize == 0) return 0;
+
+    mosaicCanvas_.create(canvasSize, canvasSize, CV_8UC3);
+    mosaicCanvas_.setTo(cv::Scalar(114, 114, 114));
+    for (const MosaicTile& tile : mosaicTiles_) {
+        cv::Mat dst = mosaicCanvas_(tile.canvas);
+        cv::resize(frame(tile.source), dst, tile.canvas.size(), 0, 0, cv::INTER_LINEAR);
+    }
+
+    try {
+        SizedBinding& sized = bindSize(canvasSize);
+        sized.preprocessor.run(mosaicCanvas_, sized.inputBuffer.data());
+        session_->Run(runOptions_, *sized.binding);
 
-        
+        const float* data = sized.outputBuffer.data();
+        std::vector<Ort::Value> dynamicOutputs;
+        std::vector<int64_t> dynamicShape;
+        if (!sized.staticOutput) {
+            dynamicOutputs = sized.binding->GetOutputValues();
+            data = dynamicOutputs[0].GetTensorData<float>();
+            dynamicShape = dynamicOutputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        }
+        const std::vector<int64_t>& shape = sized.staticOutput ? sized.outputShape : dynamicShape;
+        writeOutputDump(data, shape);
 
-        // Enhanced Non-Maximum Suppression with class-specific handling
-        std::sort(candidates.begin(), candidates.end(),
-                  [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        FrameScratch& scratch = scratch_;
+        scratch.candidates.clear();
+        decodeAnchors(data, shape[1], shape[2], scratch);
 
-        std::vector<bool> removed(candidates.size(), false);
-        for (size_t i = 0; i < candidates.size(); i++) {
-            if (removed[i]) continue;
-            
-            // Ensure classId is within bounds before accessing COCO_CLASSES
-            if (candidates[i].classId >= 0 && candidates[i].classId < 80) {
-                results.push_back({COCO_CLASSES[candidates[i].classId],
-                                   candidates[i].score, candidates[i].box});
+        // Each box belongs to the tile holding its centre; boxes in the gutter
+        // are dropped, the rest are clipped to their tile and mapped back
+        for (const DecodedAnchor& anchor : scratch.decoded) {
+            for (const MosaicTile& tile : mosaicTiles_) {
+                if (!tile.canvas.contains(cv::Point(static_cast<int>(anchor.cx), static_cast<int>(anchor.cy)))) continue;
+                float x1 = std::max(anchor.cx - anchor.w / 2.0f, static_cast<float>(tile.canvas.x));
+                float y1 = std::max(anchor.cy - anchor.h / 2.0f, static_cast<float>(tile.canvas.y));
+                float x2 = std::min(anchor.cx + anchor.w / 2.0f, static_cast<float>(tile.canvas.x + tile.canvas.width));
+                float y2 = std::min(anchor.cy + anchor.h / 2.0f, static_cast<float>(tile.canvas.y + tile.canvas.height));
+                cv::Point2f p1 = tile.toFrame(x1, y1);
+                cv::Point2f p2 = tile.toFrame(x2, y2);
+                addCandidate(scratch, (p1.x + p2.x) / 2.0f, (p1.y + p2.y) / 2.0f, p2.x - p1.x, p2.y - p1.y,
+                             anchor.score, anchor.classId, frame.size());
+                break;
             }
-            
-            // Class-specific NMS thresholds
-            float nmsThreshold = NMS_THRESH;
-            if (candidates[i].classId == 0) { // person class
-                nmsThreshold = 0.3f; // More aggressive for persons
-            } else if (candidates[i].classId >= 56 && candidates[i].classId <= 60) { // furniture
-                nmsThreshold = 0.5f; // Less aggressive for furniture (might have multiple similar items)
-            } else if (candidates[i].classId >= 61 && candidates[i].classId <= 67) { // electronics
-                nmsThreshold = 0.6f; // Even less aggressive for small electronics
+        }
+
+        suppress(scratch, results);
+    } catch (const Ort::Exception& e) {
+        std::cerr << "ROI inference failed: " << e.what() << std::endl;
+        return 0;
+    }
+    return canvasSize;
+}
+
+// Evenly spaced tiles per axis, neighbours sharing at least overlap * tileSize
+void VisionModule::computeTiles(const cv::Size& frameSize, const TilingConfig& config, std::vector<cv::Rect>& tiles) {
+    tiles.clear();
+    auto axis = [&config](int length, std::vector<int>& starts, int& size) {
+        starts.clear();
+        size = std::min(config.tileSize, length);
+        if (length <= config.tileSize) {
+            starts.push_back(0);
+            return;
+        }
+        int stride = std::max(1, static_cast<int>(config.tileSize * (1.0f - config.overlap)));
+        int count = 1 + (length - config.tileSize + stride - 1) / stride;
+        for (int i = 0; i < count; i++) {
+            starts.push_back(static_cast<int>(static_cast<int64_t>(length - config.tileSize) * i / (count - 1)));
+        }
+    };
+    std::vector<int> xs, ys;
+    int tileWidth = 0, tileHeight = 0;
+    axis(frameSize.width, xs, tileWidth);
+    axis(frameSize.height, ys, tileHeight);
+    for (int y : ys) {
+        for (int x : xs) tiles.push_back(cv::Rect(x, y, tileWidth, tileHeight));
+    }
+}
+
+void VisionModule::detectTiled(const cv::Mat& frame, std::vector<Detection>& results) {
+    results.clear();
+    if (frame.empty()) {
+        std::cerr << "Empty frame provided to detectTiled()" << std::endl;
+        return;
+    }
+    if (!ioBinding_) {
+        std::cerr << "detectTiled() called before init()" << std::endl;
+        return;
+    }
+
+    computeTiles(frame.size(), tiling_, tileRects_);
+    const size_t tileCount = tileRects_.size();
+    // A single tile already covers the whole frame
+    if (tileCount == 1) {
+        detect(frame, results);
+        return;
+    }
+    if (tiling_.fullFrameView) tileRects_.push_back(cv::Rect(0, 0, frame.cols, frame.rows));
+    const size_t count = tileRects_.size();
+
+    try {
+        const int64_t numAttrs = outputShape_.size() == 3 ? outputShape_[1] : 0;
+        const int64_t numPreds = outputShape_.size() == 3 ? outputShape_[2] : 0;
+        if (dynamicBatch_) {
+            // All tiles in one [N,3,640,640] run
+            bindBatch(count);
+            const size_t inputStride = 3 * INPUT_HEIGHT * INPUT_WIDTH;
+            cv::parallel_for_(cv::Range(0, static_cast<int>(count)), [&](const cv::Range& range) {
+                for (int i = range.start; i < range.end; i++) {
+                    batchLetterbox_[i] = batchPreprocessors_[i].run(frame(tileRects_[i]),
+                                                                   batchInputBuffer_.data() + i * inputStride);
+                }
+            });
+
+            session_->Run(runOptions_, *batchBinding_);
+
+            const float* data = batchOutputBuffer_.data();
+            std::vector<Ort::Value> dynamicOutputs;
+            std::vector<int64_t> shape = batchOutputShape_;
+            if (!batchStaticOutput_) {
+                dynamicOutputs = batchBinding_->GetOutputValues();
+                data = dynamicOutputs[0].GetTensorData<float>();
+                shape = dynamicOutputs[0].GetTensorTypeAndShapeInfo().GetShape();
             }
-            
-            for (size_t j = i + 1; j < candidates.size(); j++) {
-                if (!removed[j]) {
-                    float iouValue = iou(candidates[i].box, candidates[j].box);
-                    
-                    // Same class suppression with class-specific threshold
-                    if (candidates[i].classId == candidates[j].classId && iouValue > nmsThreshold) {
-                        removed[j] = true;
-                    }
-                    // Cross-class suppression only for very high overlap
-                    else if (iouValue > 0.8f) {
-                        removed[j] = true;
-                    }
+            writeOutputDump(data, shape);
+            const size_t outputStride = static_cast<size_t>(shape[1] * shape[2]);
+            cv::parallel_for_(cv::Range(0, static_cast<int>(count)), [&](const cv::Range& range) {
+                for (int i = range.start; i < range.end; i++) {
+                    decodeAnchors(data + i * outputStride, shape[1], shape[2], batchScratch_[i]);
+                }
+            });
+        } else {
+            // Fixed batch of 1: tiles run one after another on the primary binding
+            ensureBatchSlots(count);
+            for (size_t i = 0; i < count; i++) {
+                batchLetterbox_[i] = preprocessor_.run(frame(tileRects_[i]), inputBuffer_.data());
+                session_->Run(runOptions_, *ioBinding_);
+                if (staticOutput_) {
+                    writeOutputDump(outputBuffer_.data(), outputShape_);
+                    decodeAnchors(outputBuffer_.data(), numAttrs, numPreds, batchScratch_[i]);
+                } else {
+                    std::vector<Ort::Value> outputs = ioBinding_->GetOutputValues();
+                    std::vector<int64_t> shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+                    writeOutputDump(outputs[0].GetTensorData<float>(), shape);
+                    decodeAnchors(outputs[0].GetTensorData<float>(), shape[1], shape[2], batchScratch_[i]);
                 }
             }
         }
-        
-        
-        
     } catch (const Ort::Exception& e) {
-        std::cerr << "Inference failed: " << e.what() << std::endl;
+        std::cerr << "Tiled inference failed: " << e.what() << std::endl;
+        return;
     }
 
-    return results;
+    // Merge into frame coordinates. With a full-frame view, tile boxes cut by
+    // an inner tile border are dropped: the neighbouring tile or the full view
+    // sees that object whole.
+    static constexpr float BORDER_SLACK = 2.0f;
+    FrameScratch& scratch = scratch_;
+    scratch.candidates.clear();
+    for (size_t i = 0; i < count; i++) {
+        const cv::Rect& tile = tileRects_[i];
+        const bool isTile = i < tileCount;
+        const LetterboxTransform& letterbox = batchLetterbox_[i];
+        for (const DecodedAnchor& anchor : batchScratch_[i].decoded) {
+            cv::Point2f center = letterbox.toFrame(anchor.cx, anchor.cy);
+            float boxWidth = anchor.w / letterbox.scale;
+            float boxHeight = anchor.h / letterbox.scale;
+            if (isTile && tiling_.fullFrameView) {
+                float x1 = center.x - boxWidth / 2.0f, x2 = center.x + boxWidth / 2.0f;
+                float y1 = center.y - boxHeight / 2.0f, y2 = center.y + boxHeight / 2.0f;
+                if ((tile.x > 0 && x1 <= BORDER_SLACK) ||
+                    (tile.x + tile.width < frame.cols && x2 >= tile.width - BORDER_SLACK) ||
+                    (tile.y > 0 && y1 <= BORDER_SLACK) ||
+                    (tile.y + tile.height < frame.rows && y2 >= tile.height - BORDER_SLACK)) {
+                    continue;
+                }
+            }
+            addCandidate(scratch, center.x + tile.x, center.y + tile.y, boxWidth, boxHeight,
+                         anchor.score, anchor.classId, frame.size());
+        }
+    }
+
+    suppress(scratch, results);
 }
 
-void VisionModule::drawDetections(cv::Mat& frame, const std::vector<Detection>& detections) {
-    
-    
-    for (const auto& det : detections) {
-        // Class-specific colors for better visualization
-        cv::Scalar color = cv::Scalar(0, 255, 0); // Default green
-        
-        if (det.label == "person") color = cv::Scalar(255, 0, 0); // Blue for person
-        else if (det.label == "car" || det.label == "truck" || det.label == "bus") color = cv::Scalar(0, 0, 255); // Red for vehicles
-        else if (det.label == "chair" || det.label == "couch" || det.label == "dining table") color = cv::Scalar(0, 165, 255); // Orange for furniture
-        else if (det.label == "tv" || det.label == "laptop" || det.label == "cell phone") color = cv::Scalar(255, 255, 0); // Cyan for electronics
-        else if (det.label == "bottle" || det.label == "cup" || det.label == "bowl") color = cv::Scalar(255, 0, 255); // Magenta for containers
-        else if (det.label == "book" || det.label == "clock" || det.label == "vase") color = cv::Scalar(128, 0, 128); // Purple for decorative items
-        
-        // Adjust line thickness based on object size
-        int thickness = 2;
-        if (det.box.area() > frame.rows * frame.cols * 0.1) thickness = 4; // Large objects
-        else if (det.box.area() < frame.rows * frame.cols * 0.01) thickness = 1; // Small objects
-        
-        // Draw bounding box
-        cv::rectangle(frame, det.box, color, thickness);
-        
-        // Prepare text with confidence
-        std::string text = det.label + " " + std::to_string(static_cast<int>(det.score * 100)) + "%";
-        
-        // Adjust text size based on box size
-        double fontScale = 0.6;
-        if (det.box.area() > frame.rows * frame.cols * 0.1) fontScale = 1.0;
-        else if (det.box.area() < frame.rows * frame.cols * 0.01) fontScale = 0.4;
-        
-        // Calculate text size for background
-        int baseline = 0;
-        cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, fontScale, 2, &baseline);
-        
-        // Ensure text is within frame bounds
-        cv::Point textOrg = cv::Point(det.box.x, std::max(det.box.y - 5, textSize.height + 5));
-        
-        // Draw text background
-        cv::rectangle(frame, 
-                     cv::Point(textOrg.x - 2, textOrg.y - textSize.height - baseline - 2),
-                     cv::Point(textOrg.x + textSize.width + 2, textOrg.y + baseline + 2),
-                     color, cv::FILLED);
-        
-        // Draw text in contrasting color
-        cv::putText(frame, text, textOrg, cv::FONT_HERSHEY_SIMPLEX, fontScale,
-                    cv::Scalar(255, 255, 255), 2);
-                    
-        
-    }
-}
\ No newline at end of file
+// Decode one image's output slice ([84, 8400] or [maxDet, 6]), map boxes back
+// to the frame, apply the class policies and run NMS (anchor layout only).
+// Touches only the given scratch, so batch images can be post-processed
+// concurrently.
+void VisionModule::postprocess(const float* data, int64_t numAttrs, int64_t numPreds,
+                               const LetterboxTransform& letterbox, const cv::Size& frameSize,
+                               FrameScratch& scratch, std::vector<Detection>& results) {
+    scratch.candidates.clear();
+    decodeAnchors(data, numAttrs, numPreds, scratch);
+
+    for (const DecodedAnchor& anchor : scratch.decoded) {
+        // Undo the letterbox: model coordinates (0-640) → frame coordinates
+        cv::Point2f center = letterbox.toFrame(anchor.cx, anchor.cy);
+        addCandidate(scratch, center.x, center.y, anchor.w / letterbox.scale, anchor.h / letterbox.scale,
+                     anchor.score, anchor.classId, frameSize);
+    }
+
+    if (outputLayout_ == OutputLayout::EndToEnd) emitCandidates(scratch, results);
+    else suppress(scratch, results);
+}
+
+// Anchor layout: vectorized argmax over the (allowed) class rows; anchors below the
+// lowest class threshold are rejected before any box math, the rest are
+// checked against their own class threshold. End-to-end layout: the rows are
+// final boxes and only get the threshold test. rows/columns are the output's
+// shape[1] and shape[2].
+void VisionModule::decodeAnchors(const float* data, int64_t rows, int64_t columns, FrameScratch& scratch) {
+    scratch.decoded.clear();
+    if (outputLayout_ == OutputLayout::EndToEnd) {
+        EndToEndDecoder::decode(data, rows, ClassPolicyTable::NUM_CLASSES,
+                                policies_.minConfThreshold(), scratch.decoded, policies_.confThresholds());
+    } else {
+        int numClasses = std::min(static_cast<int>(rows - 4), ClassPolicyTable::NUM_CLASSES);
+        const std::vector<int>& allowed = policies_.classFilter().ids();
+        if (allowed.empty()) {
+            YoloDecoder::decode(data, numClasses, columns,
+                                policies_.minConfThreshold(), scratch.decoded, policies_.confThresholds());
+        } else {
+            // Allow-list: only the selected score rows (those the model has)
+            int classCount = static_cast<int>(std::lower_bound(allowed.begin(), allowed.end(), numClasses) - allowed.begin());
+            YoloDecoder::decodeSubset(data, allowed.data(), classCount, columns,
+                                      policies_.minConfThreshold(), scratch.decoded, policies_.confThresholds());
+        }
+    }
+}
+
+// Frame-space box → candidate, if it passes the class's size limits
+void VisionModule::addCandidate(FrameScratch& scratch, float centerX, float centerY, float boxWidth, float boxHeight,
+                                float score, int classId, const cv::Size& frameSize) {
+    const ClassPolicy& policy = policies_[classId];
+
+    int left = static_cast<int>(centerX - boxWidth / 2.0f);
+    int top = static_cast<int>(centerY - boxHeight / 2.0f);
+    int width = static_cast<int>(boxWidth);
+    int height = static_cast<int>(boxHeight);
+
+    // Clamp to frame boundaries and validate
+    left = std::max(0, left);
+    top = std::max(0, top);
+    width = std::min(width, frameSize.width - left);
+    height = std::min(height, frameSize.height - top);
+
+    // Reject boxes that are too small or too large for their class
+    const float frameArea = static_cast<float>(frameSize.width * frameSize.height);
+    float areaRatio = static_cast<float>(width * height) / frameArea;
+    if (width > 5 && height > 5 &&
+        areaRatio > policy.minAreaRatio && areaRatio < policy.maxAreaRatio &&
+        left + width <= frameSize.width && top + height <= frameSize.height) {
+        scratch.candidates.push_back({cv::Rect(left, top, width, height), score, classId});
+    }
+}
+
+// Class-aware NMS (per-class thresholds + cross-class 0.8), highest score first
+void VisionModule::suppress(FrameScratch& scratch, std::vector<Detection>& results) {
+    const std::vector<Candidate>& candidates = scratch.candidates;
+    NmsEngine& nms = scratch.nms;
+    nms.clear();
+    for (const Candidate& c : candidates) {
+        nms.add(static_cast<float>(c.box.x), static_cast<float>(c.box.y),
+                static_cast<float>(c.box.width), static_cast<float>(c.box.height),
+                c.score, c.classId);
+    }
+    for (int index : nms.run()) {
+        const Candidate& c = candidates[index];
+        // Ensure classId is within bounds before accessing COCO_CLASSES
+        if (c.classId >= 0 && c.classId < NUM_COCO_CLASSES) {
+            results.push_back({c.classId, c.score, c.box});
+        }
+    }
+}
+
+// End-to-end models already removed duplicates: candidates go out in the
+// network's (score-sorted) order without the NMS sort
+void VisionModule::emitCandidates(const FrameScratch& scratch, std::vector<Detection>& results) {
+    for (const Candidate& c : scratch.candidates) {
+        if (c.classId >= 0 && c.classId < NUM_COCO_CLASSES) {
+            results.push_back({c.classId, c.score, c.box});
+        }
+    }
+}
+
+void VisionModule::writeOutputDump(const float* data, const std::vector<int64_t>& shape) {
+    if (outputDumpPath_.empty()) return;
+    std::string path;
+    path.swap(outputDumpPath_);
+    size_t count = 1;
+    std::string dims;
+    for (int64_t d : shape) {
+        count *= static_cast<size_t>(d);
+        dims += (dims.empty() ? "" : "x") + std::to_string(d);
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(float)));
+    if (!out) {
+        std::cerr << "Failed to write detector output to " << path << std::endl;
+        return;
+    }
+    std::cout << "Detector output [" << dims << "] saved to " << path << std::endl;
+}
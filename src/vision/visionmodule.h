@@ -1,13 +1,54 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include <onnxruntime/onnxruntime_cxx_api.h>
+#include "preprocess.h"
+#include "alignedbuffer.h"
+#include "decoder.h"
+#include "nms.h"
+#include "classpolicy.h"
+#include "coco_labels.h"
+#include "mosaic.h"
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 struct Detection {
-    std::string label;
+    int classId;
     float score;
     cv::Rect box;
+    int trackId = -1;  // set by SimpleTracker on its output
+
+    const char* label() const { return cocoLabel(classId); }
+};
+
+// Sliced inference over large frames
+struct TilingConfig {
+    int tileSize = 640;         // frame pixels per tile side (native resolution)
+    float overlap = 0.2f;       // fraction of a tile shared with its neighbour
+    bool fullFrameView = true;  // also run the whole frame, for objects larger than the overlap
+};
+
+// ONNX Runtime session tuning. The defaults are ORT's own; whisper and llama
+// each run 4 threads, so capping intraOpThreads avoids oversubscription.
+struct SessionConfig {
+    int intraOpThreads = 0;          // 0 = ORT default (one per physical core)
+    int interOpThreads = 0;          // only used with parallelExecution
+    bool allowSpinning = true;       // pool threads busy-wait between ops
+    bool parallelExecution = false;  // ORT_PARALLEL: run independent graph branches concurrently
+    bool memoryPattern = true;       // plan activation memory from the first run
+    bool cpuArena = true;            // ORT's CPU memory arena
+    std::vector<std::string> providers;  // extra CPU EPs in priority order, e.g. "XNNPACK"
+
+    // Short human-readable summary, e.g. "intra=4 inter=0 spin seq xnnpack"
+    std::string describe() const;
+};
+
+struct Candidate {
+    cv::Rect box;
+    float score;
+    int classId;
 };
 
 class VisionModule {
@@ -16,16 +57,182 @@ public:
     ~VisionModule(); // Added destructor for proper cleanup
     
     bool init();
+
+    // Threads, execution mode, memory and execution providers. Set before init().
+    void setSessionConfig(const SessionConfig& config) { sessionConfig_ = config; }
+    const SessionConfig& sessionConfig() const { return sessionConfig_; }
+
+    // Weights container shared with other sessions of the same model (not
+    // owned; nullptr = private copy). Set before init().
+    void setPrepackedWeights(Ort::PrepackedWeightsContainer* container) { prepackedWeights_ = container; }
+
+    // Directory for ORT-optimized model files (empty = no cache). Set before init().
+    void setModelCacheDir(const std::string& dir) { modelCacheDir_ = dir; }
+    // Session creation time of the last init(), and whether it came from the cache
+    double sessionCreateMs() const { return sessionCreateMs_; }
+    bool sessionFromCache() const { return sessionFromCache_; }
     std::vector<Detection> detect(const cv::Mat& frame);
-    void drawDetections(cv::Mat& frame, const std::vector<Detection>& detections);
+    // Allocation-free variant: results is cleared and refilled, keeping its capacity
+    void detect(const cv::Mat& frame, std::vector<Detection>& results);
+
+    // Batched inference: one [N,3,H,W] tensor and a single Session::Run, then
+    // per-image decoding in parallel. Requires a model exported with a dynamic
+    // batch dimension; with a fixed batch of 1 the frames are run one at a time.
+    // results is resized to count and results[i] belongs to frames[i].
+    void detectBatch(const cv::Mat* frames, size_t count, std::vector<std::vector<Detection>>& results);
+    void detectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<Detection>>& results);
+    bool supportsBatch() const { return dynamicBatch_; }
+
+    // Detection restricted to frame regions (e.g. expanded track boxes). The
+    // regions are packed at keyframe scale into the smallest square mosaic
+    // canvas (320-640 px) that holds them and run as one inference. Needs a
+    // model with dynamic input height/width. Returns the canvas side used, or
+    // 0 if nothing was run (fixed-size model or the regions do not fit).
+    int detectRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                      std::vector<Detection>& results);
+    bool supportsVariableInput() const { return dynamicInputSize_; }
+
+    // Square network input side used by detect(): 640 (default) or a reduced
+    // size such as 320/416/512. Boxes are mapped back to the frame either way.
+    // Ignored (stays 640) for models with a fixed input size.
+    void setInputSize(int size);
+    int inputSize() const { return inputSize_; }
+    // Wall time of the last detect() Session::Run, for latency controllers
+    double lastRunMs() const { return lastRunMs_; }
+
+    // Tiled mode for high-resolution frames: the frame is cut into overlapping
+    // tiles that are fed at native resolution (plus an optional full-frame
+    // view) as one batched run, decoded in parallel and merged with the
+    // class-aware NMS. Small objects survive that a 640 squash would lose.
+    void detectTiled(const cv::Mat& frame, std::vector<Detection>& results);
+    void setTiling(const TilingConfig& config) { tiling_ = config; }
+    const TilingConfig& tiling() const { return tiling_; }
+    // Tile rectangles detectTiled() would use (excluding the full-frame view)
+    static void computeTiles(const cv::Size& frameSize, const TilingConfig& config, std::vector<cv::Rect>& tiles);
+
+    // Anchor grid needing NMS (YOLOv8) or NMS-free final boxes (YOLOv10-style)
+    OutputLayout outputLayout() const { return outputLayout_; }
+
+    // "fp32", or the quantization tag of a model made by tools/quantize_yolo.py
+    const std::string& modelPrecision() const { return modelPrecision_; }
+
+    // Per-class thresholds/colors; optional file overrides on top of the defaults
+    bool loadClassPolicies(const std::string& path);
+    const ClassPolicyTable& classPolicies() const { return policies_; }
+    // Policies (class filter included) already loaded by another module
+    void setClassPolicies(const ClassPolicyTable& policies);
+    // Only decode these classes: the argmax visits just their score rows
+    void setClassFilter(const ClassFilter& filter) { policies_.setClassFilter(filter); }
+    const ClassFilter& classFilter() const { return policies_.classFilter(); }
+
+    // Write the raw output tensor of the next inference run on this module
+    // ([1,84,8400] floats, [N,84,8400] for a batched run) to path for offline
+    // benchmarks. Tiled runs on a batch-1 model dump the first tile. Not
+    // thread-safe: call from the thread running detect(), e.g. through
+    // VisionPipeline::requestOutputDump().
+    void dumpNextOutput(const std::string& path) { outputDumpPath_ = path; }
 
 private:
     std::string modelPath_;
+    std::string modelPrecision_ = "fp32";
+    std::string modelCacheDir_;
+    SessionConfig sessionConfig_;
+    Ort::PrepackedWeightsContainer* prepackedWeights_ = nullptr;
+    Ort::Session* openSession(const std::string& path, const Ort::SessionOptions& options);
+    void applySessionConfig();
+    double sessionCreateMs_ = 0.0;
+    bool sessionFromCache_ = false;
+    void createSession();
+    std::string optimizationKey() const;
     Ort::Env env_;
     Ort::Session* session_;
     Ort::SessionOptions sessionOptions_;
     std::vector<const char*> inputNodeNames_;
     std::vector<const char*> outputNodeNames_;
     
-    cv::Mat preprocess(const cv::Mat& frame);
+    Preprocessor preprocessor_;
+    ClassPolicyTable policies_;
+    void applyClassPolicies();
+
+    // Post-processing scratch; one per image decoded concurrently
+    struct FrameScratch {
+        std::vector<DecodedAnchor> decoded;
+        std::vector<Candidate> candidates;
+        NmsEngine nms;
+    };
+    void configureScratch(FrameScratch& scratch);
+    void postprocess(const float* data, int64_t numAttrs, int64_t numPreds,
+                     const LetterboxTransform& letterbox, const cv::Size& frameSize,
+                     FrameScratch& scratch, std::vector<Detection>& results);
+    void decodeAnchors(const float* data, int64_t rows, int64_t columns, FrameScratch& scratch);
+    void addCandidate(FrameScratch& scratch, float centerX, float centerY, float boxWidth, float boxHeight,
+                      float score, int classId, const cv::Size& frameSize);
+    void suppress(FrameScratch& scratch, std::vector<Detection>& results);
+    void emitCandidates(const FrameScratch& scratch, std::vector<Detection>& results);
+    OutputLayout outputLayout_ = OutputLayout::Anchors;
+
+    // Persistent, pre-bound tensors: input [1,3,H,W] and output [1,84,8400]
+    void bindTensors();
+    AlignedBuffer<float> inputBuffer_;
+    AlignedBuffer<float> outputBuffer_;
+    std::vector<int64_t> inputShape_;
+    std::vector<int64_t> outputShape_;
+    Ort::Value inputTensor_{nullptr};
+    Ort::Value outputTensor_{nullptr};
+    bool staticOutput_ = false;
+    std::unique_ptr<Ort::IoBinding> ioBinding_;
+    std::string outputDumpPath_;
+    void writeOutputDump(const float* data, const std::vector<int64_t>& shape);
+    Ort::RunOptions runOptions_;
+
+    // Reused per-frame scratch
+    FrameScratch scratch_;
+
+    // Batch path: [N,3,H,W] → [N,84,8400], rebound only when N changes and
+    // reallocated only when N grows. One preprocessor (and its cached resize
+    // tables) per batch slot, so a fixed camera-to-slot mapping stays warm.
+    void bindBatch(size_t count);
+    void ensureBatchSlots(size_t count);
+    bool dynamicBatch_ = false;
+    size_t boundBatch_ = 0;
+    AlignedBuffer<float> batchInputBuffer_;
+    AlignedBuffer<float> batchOutputBuffer_;
+    std::vector<int64_t> batchInputShape_;
+    std::vector<int64_t> batchOutputShape_;
+    Ort::Value batchInputTensor_{nullptr};
+    Ort::Value batchOutputTensor_{nullptr};
+    bool batchStaticOutput_ = false;
+    std::unique_ptr<Ort::IoBinding> batchBinding_;
+    std::vector<Preprocessor> batchPreprocessors_;
+    std::vector<LetterboxTransform> batchLetterbox_;
+    std::vector<FrameScratch> batchScratch_;
+
+    // Square inputs other than the primary 640 binding, bound on first use
+    // (dynamic height/width models only)
+    struct SizedBinding {
+        explicit SizedBinding(int side) : size(side), preprocessor(side, side) {}
+        int size;
+        Preprocessor preprocessor;
+        AlignedBuffer<float> inputBuffer;
+        AlignedBuffer<float> outputBuffer;
+        std::vector<int64_t> inputShape;
+        std::vector<int64_t> outputShape;
+        Ort::Value inputTensor{nullptr};
+        Ort::Value outputTensor{nullptr};
+        bool staticOutput = false;
+        std::unique_ptr<Ort::IoBinding> binding;
+    };
+    SizedBinding& bindSize(int size);
+    bool dynamicInputSize_ = false;
+    int inputSize_ = 640;
+    double lastRunMs_ = 0.0;
+    std::map<int, std::unique_ptr<SizedBinding>> sizedBindings_;
+
+    // Tiled mode
+    TilingConfig tiling_;
+    std::vector<cv::Rect> tileRects_;
+
+    // ROI mosaic scratch
+    std::vector<MosaicTile> mosaicTiles_;
+    cv::Mat mosaicCanvas_;
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Static INT8 (QDQ) quantization of the YOLOv8 detector.
+
+Reads the float32 [3,640,640] tensors written by calib_dump, calibrates
+activation ranges on them and writes a QDQ model that VisionModule loads like
+the fp32 one (input and output stay float). Normally run through the
+`quantize_model` CMake target.
+"""
+import argparse
+import glob
+import os
+import sys
+
+import numpy as np
+import onnx
+from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                      QuantType, quantize_static)
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+INPUT_SIZE = 640
+# Ultralytics exports the Detect head (DFL, box decode, class sigmoid) under
+# this prefix; keeping it in fp32 preserves box precision for little cost.
+DETECT_HEAD_PREFIX = "/model.22/"
+
+
+class TensorReader(CalibrationDataReader):
+    def __init__(self, tensor_dir, input_name):
+        self.files = sorted(glob.glob(os.path.join(tensor_dir, "*.bin")))
+        self.input_name = input_name
+        self.index = 0
+
+    def get_next(self):
+        if self.index >= len(self.files):
+            return None
+        data = np.fromfile(self.files[self.index], dtype=np.float32)
+        self.index += 1
+        return {self.input_name: data.reshape(1, 3, INPUT_SIZE, INPUT_SIZE)}
+
+    def rewind(self):
+        self.index = 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--model", required=True, help="fp32 YOLOv8 ONNX model")
+    parser.add_argument("--calibration", required=True, help="directory of calib_dump tensors")
+    parser.add_argument("--output", required=True, help="INT8 QDQ model to write")
+    parser.add_argument("--method", choices=["minmax", "entropy", "percentile"], default="percentile")
+    parser.add_argument("--quantize-head", action="store_true",
+                        help="also quantize the Detect head (smaller, less accurate)")
+    args = parser.parse_args()
+
+    prepared = args.output + ".prep.onnx"
+    quant_pre_process(args.model, prepared)
+    # quantize_static sees the pre-processed graph, whose node names can differ
+    # from the original's: take the input and the head's nodes from it
+    model = onnx.load(prepared)
+    input_name = model.graph.input[0].name
+    reader = TensorReader(args.calibration, input_name)
+    if not reader.files:
+        os.remove(prepared)
+        sys.exit(f"no calibration tensors in {args.calibration}")
+
+    excluded = [] if args.quantize_head else \
+        [n.name for n in model.graph.node if n.name.startswith(DETECT_HEAD_PREFIX)]
+    if not args.quantize_head and not excluded:
+        os.remove(prepared)
+        sys.exit(f"no Detect head nodes ({DETECT_HEAD_PREFIX}*) in the pre-processed model; "
+                 "pass --quantize-head to quantize everything")
+
+    method = {"minmax": CalibrationMethod.MinMax,
+              "entropy": CalibrationMethod.Entropy,
+              "percentile": CalibrationMethod.Percentile}[args.method]
+    quantize_static(prepared, args.output, reader,
+                    quant_format=QuantFormat.QDQ,
+                    per_channel=True,
+                    activation_type=QuantType.QUInt8,
+                    weight_type=QuantType.QInt8,
+                    calibrate_method=method,
+                    nodes_to_exclude=excluded)
+    os.remove(prepared)
+
+    # Tag read back by VisionModule::modelPrecision()
+    quantized = onnx.load(args.output)
+    tag = quantized.metadata_props.add()
+    tag.key = "quantization"
+    tag.value = "int8-qdq"
+    onnx.save(quantized, args.output)
+
+    print(f"Calibrated on {len(reader.files)} tensors ({args.method}), "
+          f"{len(excluded)} head nodes kept fp32 -> {args.output}")
+
+
+if __name__ == "__main__":
+    main()